@@ -0,0 +1,66 @@
+// class_H5Handle.cpp
+// scoped owner of an hdf5 identifier
+// Ladislav Meri, SHMU
+
+#include "class_H5Handle.hpp"
+
+namespace myodim {
+
+H5Handle::H5Handle(H5Handle&& other) noexcept : id_(other.id_) {
+  other.id_ = -1;
+}
+
+H5Handle& H5Handle::operator=(H5Handle&& other) noexcept {
+  if ( this != &other ) {
+    reset(other.id_);
+    other.id_ = -1;
+  }
+  return *this;
+}
+
+H5Handle::~H5Handle() {
+  close(id_);
+}
+
+hid_t H5Handle::release() {
+  const hid_t id = id_;
+  id_ = -1;
+  return id;
+}
+
+void H5Handle::reset(const hid_t id) {
+  if ( id == id_ ) return;
+  close(id_);
+  id_ = id;
+}
+
+herr_t H5Handle::close(const hid_t id) {
+  if ( id < 0 ) return 0;
+  switch ( H5Iget_type(id) ) {
+    case H5I_FILE :
+      return H5Fclose(id);
+    case H5I_GROUP :
+      return H5Gclose(id);
+    case H5I_DATATYPE :
+      return H5Tclose(id);
+    case H5I_DATASPACE :
+      return H5Sclose(id);
+    case H5I_DATASET :
+      return H5Dclose(id);
+    case H5I_ATTR :
+      return H5Aclose(id);
+    case H5I_GENPROP_LST :
+      return H5Pclose(id);
+    case H5I_BADID :
+      return -1;
+    default :
+      return H5Idec_ref(id) < 0 ? -1 : 0;
+  }
+}
+
+size_t H5Handle::openObjectCount(const hid_t file) {
+  const ssize_t count = H5Fget_obj_count(file, H5F_OBJ_ALL);
+  return count > 0 ? static_cast<size_t>(count) : 0;
+}
+
+} // end namespace myodim
@@ -0,0 +1,40 @@
+// class_H5Handle.hpp
+// scoped owner of an hdf5 identifier
+// Ladislav Meri, SHMU
+
+#ifndef CLASS_H5HANDLE_HPP
+#define CLASS_H5HANDLE_HPP
+
+#include <cstddef>
+#include <hdf5.h>
+
+namespace myodim {
+
+// closes the owned identifier with the close function of its type (H5Aclose, H5Tclose, ...)
+// when going out of scope, so no error path can leak it
+class H5Handle {
+  public:
+    H5Handle() = default;
+    explicit H5Handle(const hid_t id): id_(id) {};
+    H5Handle(const H5Handle&) = delete;
+    H5Handle& operator=(const H5Handle&) = delete;
+    H5Handle(H5Handle&& other) noexcept;
+    H5Handle& operator=(H5Handle&& other) noexcept;
+    ~H5Handle();
+
+    operator hid_t() const {return id_;};
+    hid_t get() const {return id_;};
+    bool isValid() const {return id_ >= 0;};
+    hid_t release();                 // gives up the ownership without closing
+    void reset(const hid_t id=-1);   // closes the owned identifier and takes the new one
+
+    static herr_t close(const hid_t id);                        // closes any identifier by its H5Iget_type
+    static size_t openObjectCount(const hid_t file=H5F_OBJ_ALL);  // open identifiers of the file, H5F_OBJ_ALL - of all files
+
+  private:
+    hid_t id_{-1};
+};
+
+} // end namespace myodim
+
+#endif // CLASS_H5HANDLE_HPP
@@ -3,20 +3,77 @@
 // Ladislav Meri, SHMU
 
 #include "class_H5Layout.hpp"
+#include "class_H5Handle.hpp"
+#include "class_H5NativeReader.hpp"
+#include "module_FileAccess.hpp"
+#include "module_Statistics.hpp"
 
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
-#include <limits>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <exception>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace myodim {
 
+
+struct ObjectCollector {   // what the H5Ovisit callback fills
+  H5PathTrie* paths;
+  std::vector<h5Entry>* groups;
+  std::vector<h5Entry>* datasets;
+};
+
 static herr_t fillGroupsAndDatasets(hid_t loc_id, const char* name, 
-                                    const H5O_info_t* info, void* ph5layout);
+                                    const H5O_info_t* info, void* pCollector);
+
+struct VisitContext {   // what the streaming H5Ovisit callback needs
+  hid_t file;
+  H5LayoutVisitor* visitor;
+  std::exception_ptr error;   // exceptions must not go through the HDF5 library
+};
+
+static herr_t visitObject(hid_t loc_id, const char* name, const H5O_info_t* info, void* pContext);
+static void forEachAttribute(hid_t file, const std::string& objPath,
+                             const std::function<void(const std::string&, hid_t)>& process);
+static bool isUcharType(hid_t type);
+
 static herr_t getAttributeName(hid_t loc_id, const char* name, const H5A_info_t* ainfo, void* pNameStr);
+static void fillAttributeInfo(hid_t attr, h5AttributeInfo& info);
 static void splitAttributeToPathAndName(const std::string& attrName, 
                                         std::string& path, std::string& name);
-static void closeAll(const std::vector<hid_t>& ids);
+static void throwIfError(const h5Error& error);
+static herr_t getHardLinkName(hid_t group, const char* name, const H5L_info_t* info, void* pNames);
+static std::string literalPrefix(const std::string& nodeRegex);
+static std::string literalSuffix(const std::string& nodeRegex);
+static std::string childPrefix(const std::string& objPath);
+static bool startsWith(const std::string& str, const std::string& prefix);
+static bool endsWith(const std::string& str, const std::string& suffix);
+static int compareReversed(const std::string& a, const std::string& b, const size_t n);
+static void buildAnchorIndex(const std::vector<h5Entry>& entries, std::vector<uint32_t>& byPrefix,
+                             std::vector<uint32_t>& bySuffix);
+static bool isHdf5Image(const void* image, const size_t imageSize);
+static bool fnv1aFileHash(const std::string& filePath, uint64_t& hash);
+template <typename T> static void writeValue(std::ostream& out, const T& value);
+template <typename T> static bool readValue(std::istream& in, T& value);
+static void writeString(std::ostream& out, const std::string& str);
+static bool readString(std::istream& in, std::string& str);
+template <typename T> static void writeVector(std::ostream& out, const std::vector<T>& v);
+template <typename T> static bool readVector(std::istream& in, std::vector<T>& v);
+
+// the HDF5 library is built without its thread-safety option - the accessors used by the compare workers
+// take this lock before any HDF5 call, the prefetched values are read without it
+static std::recursive_mutex hdf5Mutex;
+
+static const char SNAPSHOT_MAGIC[] = "ODIMH5LAYOUT1";
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+static hid_t createImageFapl(void* pImage);
 
 H5Layout::H5Layout() {
   H5Eset_auto( H5E_DEFAULT, NULL, NULL ); //Turn off error handling permanently
@@ -27,30 +84,253 @@ H5Layout::H5Layout(const std::string& h5FilePath) {
   explore(h5FilePath);
 }
 
+H5Layout::H5Layout(const void* image, const size_t imageSize, const std::string& imageName) {
+  H5Eset_auto( H5E_DEFAULT, NULL, NULL ); //Turn off error handling permanently 
+  exploreImage(image, imageSize, imageName);
+}
+
 H5Layout::~H5Layout() {
   reset_();
 }
 
 void H5Layout::explore(const std::string& h5FilePath) {
   reset_();
-  checkAndOpenFile_(h5FilePath);
+  if ( useMmap_ ) {
+    mapAndOpenFile_(h5FilePath);
+  }
+  else {
+    checkAndOpenFile_(h5FilePath);
+  }
+  if ( snapshotDir_.empty() || !targetPrefixes_.empty() ) {
+    exploreAll_();
+    return;
+  }
+  // the file stays open for the values not kept in the snapshot
+  std::string snapshotPath;
+  const std::string key = snapshotKey_(h5FilePath, snapshotPath);
+  if ( !key.empty() && loadSnapshot_(snapshotPath, key) ) {
+    fromSnapshot_ = true;
+    buildIndex_();
+    return;
+  }
+  const bool prefetch = prefetchValues_;
+  prefetchValues_ = true;     // the snapshot keeps the values too
+  exploreAll_();
+  prefetchValues_ = prefetch;
+  if ( !key.empty() ) saveSnapshot_(snapshotPath, key);
+}
+
+// the targets apply to this walk only, the ones set by setExploreTargets are used again by the next explore
+void H5Layout::explore(const std::string& h5FilePath, const std::vector<std::string>& targets) {
+  const std::vector<std::string> previousPrefixes = targetPrefixes_;
+  setExploreTargets(targets);
+  try {
+    explore(h5FilePath);
+  }
+  catch (...) {
+    targetPrefixes_ = previousPrefixes;
+    throw;
+  }
+  targetPrefixes_ = previousPrefixes;
+}
+
+void H5Layout::setExploreTargets(const std::vector<std::string>& targets) {
+  targetPrefixes_.clear();
+  for (const auto& target : targets) {
+    targetPrefixes_.push_back(literalPrefix(target));
+    if ( targetPrefixes_.back().empty() ) {    // a target matching anything - the whole file is needed
+      targetPrefixes_.clear();
+      return;
+    }
+  }
+}
+
+void H5Layout::visit(const std::string& h5FilePath, H5LayoutVisitor& visitor) {
+  reset_();
+  if ( useMmap_ ) {
+    mapAndOpenFile_(h5FilePath);
+  }
+  else {
+    checkAndOpenFile_(h5FilePath);
+  }
+  VisitContext context{h5FileID_, &visitor, nullptr};
+  herr_t status = H5Ovisit(h5FileID_, H5_INDEX_NAME, H5_ITER_NATIVE, visitObject, &context);
+  reset_();
+  if ( context.error ) std::rethrow_exception(context.error);
+  if ( status < 0 ) {
+    throw std::runtime_error{"ERROR - error while iterating objects in "+h5FilePath};
+  }
+}
+
+void H5Layout::exploreImage(const void* image, const size_t imageSize, const std::string& imageName) {
+  reset_();
+  checkAndOpenImage_(image, imageSize, imageName);
+  exploreAll_();
+}
+
+void H5Layout::exploreOpened_() {
   findGroupsAndDatasets_();
   findAttributes_();
+  buildIndex_();
+}
+
+void H5Layout::exploreAll_() {
+  if ( useNativeReader_ && targetPrefixes_.empty() && exploreNative_() ) {
+    fromNativeReader_ = true;
+    buildIndex_();
+    return;
+  }
+  exploreOpened_();
+}
+
+// fills the layout from the file image without the HDF5 library, false if the file uses something not supported;
+// the file stays open in the library for the dataset checks and for the values not decoded here
+bool H5Layout::exploreNative_() {
+  const void* image = image_.data;
+  size_t imageSize = image_.size;
+  void* mapped = nullptr;
+  if ( !image ) {
+    int fd = open(h5FilePath_.c_str(), O_RDONLY);
+    struct stat st;
+    if ( fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0 ) {
+      if ( fd >= 0 ) close(fd);
+      return false;
+    }
+    mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if ( mapped == MAP_FAILED ) return false;
+    image = mapped;
+    imageSize = st.st_size;
+  }
+
+  std::vector<h5NativeObject> objects;
+  H5NativeReader reader(image, imageSize);
+  const bool isRead = reader.read(objects);
+  if ( isRead ) {
+    std::vector<uint32_t> nodes(objects.size(), H5PathTrie::ROOT);
+    for (size_t i=0; i<objects.size(); ++i) {
+      if ( objects[i].parent != UINT32_MAX ) {
+        nodes[i] = paths_->insertChild(nodes[objects[i].parent], objects[i].name);
+      }
+      auto& entries = objects[i].isGroup ? groups : datasets;
+      entries.push_back(h5Entry(paths_.get(), nodes[i], false));
+    }
+    // the groups first, then the datasets, as in findAttributes_()
+    for (const bool isGroup : {true, false}) {
+      for (size_t i=0; i<objects.size(); ++i) {
+        if ( objects[i].isGroup != isGroup ) continue;
+        for (const auto& attr : objects[i].attributes) {
+          attributes.push_back(h5Entry(paths_.get(), paths_->insertChild(nodes[i], attr.name), false));
+          attributeInfos_.push_back(attr.info);
+          ValueSlot slot;
+          decodeValue_(attr, slot);    // decoding needs no library call, so the values are always kept
+          valueSlots_.push_back(slot);
+        }
+      }
+    }
+  }
+  if ( mapped ) munmap(mapped, imageSize);
+  return isRead;
+}
+
+const H5PathTrie& H5Layout::paths() const {
+  return *paths_;
 }
 
 bool H5Layout::hasAttribute(const std::string& attrName) const {
-  return std::find(attributes.begin(), attributes.end(), h5Entry(attrName,false)) != attributes.end() ||
-         std::find(attributes.begin(), attributes.end(), h5Entry(attrName,true)) != attributes.end();
+  return indexOf_(attributeIndex_, attrName) != NOT_FOUND;
 }
 
 bool H5Layout::hasGroup(const std::string& groupName) const {
-  return std::find(groups.begin(), groups.end(), h5Entry(groupName,false)) != groups.end() ||
-         std::find(groups.begin(), groups.end(), h5Entry(groupName,true)) != groups.end();
+  return indexOf_(groupIndex_, groupName) != NOT_FOUND;
 }
 
 bool H5Layout::hasDataset(const std::string& dsetName) const {
-  return std::find(datasets.begin(), datasets.end(), h5Entry(dsetName,false)) != datasets.end() ||
-         std::find(datasets.begin(), datasets.end(), h5Entry(dsetName,true)) != datasets.end();
+  return indexOf_(datasetIndex_, dsetName) != NOT_FOUND;
+}
+
+size_t H5Layout::findGroup(const std::string& groupName) const {
+  return indexOf_(groupIndex_, groupName);
+}
+
+size_t H5Layout::findDataset(const std::string& dsetName) const {
+  return indexOf_(datasetIndex_, dsetName);
+}
+
+size_t H5Layout::findAttribute(const std::string& attrName) const {
+  return indexOf_(attributeIndex_, attrName);
+}
+
+void H5Layout::candidateGroups(const std::string& nodeRegex, std::vector<size_t>& indexes) const {
+  candidates_(groups, groupAnchors_, nodeRegex, indexes);
+}
+
+void H5Layout::candidateDatasets(const std::string& nodeRegex, std::vector<size_t>& indexes) const {
+  candidates_(datasets, datasetAnchors_, nodeRegex, indexes);
+}
+
+void H5Layout::candidateAttributes(const std::string& nodeRegex, std::vector<size_t>& indexes) const {
+  candidates_(attributes, attributeAnchors_, nodeRegex, indexes);
+}
+
+void H5Layout::setValuePrefetch(const bool prefetch, const size_t maxBytes) {
+  prefetchValues_ = prefetch;
+  maxPrefetchBytes_ = maxBytes;
+}
+
+size_t H5Layout::prefetchedValuesBytes() const {
+  return stringArena_.size() +
+         realArena_.size()*sizeof(double) +
+         intArena_.size()*sizeof(int64_t) +
+         valueSlots_.size()*sizeof(ValueSlot);
+}
+
+void H5Layout::setSnapshotCache(const std::string& cacheDir, const bool useContentHash) {
+  snapshotDir_ = cacheDir;
+  snapshotHash_ = useContentHash;
+}
+
+bool H5Layout::isFromSnapshot() const {
+  return fromSnapshot_;
+}
+
+void H5Layout::setMmap(const bool useMmap) {
+  useMmap_ = useMmap;
+}
+
+void H5Layout::setNativeReader(const bool useNativeReader) {
+  useNativeReader_ = useNativeReader;
+}
+
+bool H5Layout::isFromNativeReader() const {
+  return fromNativeReader_;
+}
+
+void H5Layout::setIoProfile(const std::string& ioProfile) {
+  if ( !isIoProfile(ioProfile) ) {
+    throw std::runtime_error{"ERROR - unknown io profile "+ioProfile+
+                             " - possible values: default, network-fs"};
+  }
+  ioProfile_ = ioProfile;
+}
+
+double H5Layout::metadataCacheHitRate() const {
+  double hitRate = -1.0;
+  if ( h5FileID_ < 0 || H5Fget_mdc_hit_rate(h5FileID_, &hitRate) < 0 ) return -1.0;
+  return hitRate;
+}
+
+void H5Layout::setHandleCacheSize(const size_t size) {
+  clearHandleCache_();
+  handleCacheSize_ = size;
+}
+
+size_t H5Layout::handleCacheHits() const {
+  return handleCacheHits_;
+}
+
+size_t H5Layout::handleCacheMisses() const {
+  return handleCacheMisses_;
 }
 
 std::string H5Layout::filePath() const {
@@ -58,399 +338,322 @@ std::string H5Layout::filePath() const {
 }
 
 std::vector<std::string> H5Layout::getAttributeNames(const std::string& objPath) const {
-  bool isGroup = true;
-  hid_t object = H5Gopen2(h5FileID_, objPath.c_str(), H5P_DEFAULT);
-  if ( object < 0 ) {
-    object = H5Dopen2(h5FileID_, objPath.c_str(), H5P_DEFAULT);
-    if ( object < 0 ) {
+  H5Handle object(H5Gopen2(h5FileID_, objPath.c_str(), H5P_DEFAULT));
+  if ( !object.isValid() ) {
+    object.reset(H5Dopen2(h5FileID_, objPath.c_str(), H5P_DEFAULT));
+    if ( !object.isValid() ) {
       throw std::runtime_error{"ERROR - object "+objPath+" not opened"};
     }
-    isGroup = false;
   }
   std::vector<std::string> attrNames;
   auto status = H5Aiterate2(object, H5_INDEX_NAME, H5_ITER_INC, NULL, getAttributeName, &attrNames);
   if ( status < 0 ) throw std::runtime_error{"ERROR - error while iterating attributes in object "+objPath};
-  if ( isGroup ) status = H5Gclose(object);
-  else status = H5Dclose(object);
+  status = H5Handle::close(object.release());
   if ( status < 0 ) throw std::runtime_error{"ERROR - error while closing object "+objPath};
   return attrNames;
 }
 
-void H5Layout::getAttributeValue(const std::string& attrName, std::string& value) const {
-  value = "";
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    closeAll({parent});
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto type = H5Aget_type(attr);
-  if ( type < 0 ) {
-    closeAll({attr, parent});
-    throw std::runtime_error("ERROR - attribute type not found");
-  }
-  if ( H5Tget_class(type) != H5T_STRING ) {
-    closeAll({type, attr, parent});
-    throw std::runtime_error("ERROR - attribute "+attrName+" is not a STRING attribute");
-  }
-  if ( H5Tis_variable_str(type) ) {
-    closeAll({type, attr, parent});
-	  throw std::runtime_error("WARNING - NON-STANDARD DATA TYPE - attribute "+
-			                   attrName+" is a variable-length string attribute,"+
-			                   " which is not supported by the ODIM standard.");
+const h5AttributeInfo& H5Layout::attributeInfo(const std::string& attrName) const {
+  h5Error error;
+  const h5AttributeInfo* info = findAttributeInfo(attrName, error);
+  throwIfError(error);
+  return *info;
+}
+
+const h5AttributeInfo& H5Layout::attributeInfoAt(const size_t index) const {
+  return attributeInfos_.at(index);
+}
+
+const h5AttributeInfo* H5Layout::findAttributeInfo(const std::string& attrName, h5Error& error) const {
+  const size_t found = indexOf_(attributeIndex_, attrName);
+  if ( found == NOT_FOUND && isPartial_ ) return untargetedAttributeInfo_(attrName, error);
+  if ( found == NOT_FOUND ) {
+    std::string path, name;
+    splitAttributeToPathAndName(attrName, path, name);
+    const std::string objPath = path.length() > 1 ? path.substr(0, path.length()-1) : path;
+    if ( !hasGroup(objPath) && !hasDataset(objPath) ) {
+      error = h5Error(h5Error::NodeNotOpened, "ERROR - node "+path+" not opened");
+    }
+    else {
+      error = h5Error(h5Error::AttributeNotOpened, "ERROR - attribute "+attrName+" not opened");
+    }
+    return nullptr;
   }
+  return &attributeInfos_[found];
+}
 
-  auto sz = H5Tget_size(type);
+// the attributes the targeted explore skipped are still in the file, their info is read once and kept
+const h5AttributeInfo* H5Layout::untargetedAttributeInfo_(const std::string& attrName, h5Error& error) const {
+  std::lock_guard<std::recursive_mutex> lock(hdf5Mutex);
+  const auto cached = untargetedInfos_.find(attrName);
+  if ( cached != untargetedInfos_.end() ) return &cached->second;
+  const H5Handle attr = openAttribute_(attrName, error);
+  if ( !attr.isValid() ) return nullptr;
+  h5AttributeInfo& info = untargetedInfos_[attrName];
+  fillAttributeInfo(attr, info);
+  return &info;
+}
 
-  char* str;
-  str = (char*)malloc(sz+1);
-  str[sz] = '\0';
-  auto ret  = H5Aread(attr, type, str);
-  if ( ret < 0  ) {
-    closeAll({type, attr, parent});
-    throw std::runtime_error("ERROR - attribute "+attrName+" not read");
+void H5Layout::loadAttributeValues(const std::vector<std::string>& attrNames) {
+  std::lock_guard<std::recursive_mutex> lock(hdf5Mutex);
+  valueSlots_.resize(attributes.size());
+  std::vector<size_t> toLoad;
+  toLoad.reserve(attrNames.size());
+  for (const auto& attrName : attrNames) {
+    const size_t found = indexOf_(attributeIndex_, attrName);
+    if ( found != NOT_FOUND && valueSlots_[found].tag == NotPrefetched ) toLoad.push_back(found);
   }
-  value = str;
-  free(str);
+  // sorted by the parent, so each object is opened only once
+  std::sort(toLoad.begin(), toLoad.end(), [this](size_t a, size_t b) {
+    const uint32_t parentA = paths_->parent(attributes[a].node());
+    const uint32_t parentB = paths_->parent(attributes[b].node());
+    return parentA != parentB ? parentA < parentB : a < b;
+  });
+  toLoad.erase(std::unique(toLoad.begin(), toLoad.end()), toLoad.end());
 
-  if ( value.length()+1 != sz ) {
-    closeAll({type, attr, parent});
-	  throw std::runtime_error("WARNING - STRSIZE error - attribute "+
-			                   attrName+"`s size is set to "+std::to_string(sz)+", but it should be "+
-                         std::to_string(value.length()+1)+ " (value.length+1) - value is now: "+value);
+  for (size_t i=0; i<toLoad.size(); ) {
+    const uint32_t parentNode = paths_->parent(attributes[toLoad[i]].node());
+    const std::string parentPath = paths_->path(parentNode);
+    const H5Handle parent(H5Oopen(h5FileID_, parentPath.c_str(), H5P_DEFAULT));
+    for ( ; i<toLoad.size() && paths_->parent(attributes[toLoad[i]].node()) == parentNode; ++i) {
+      if ( !parent.isValid() ) continue;   // the accessors report the error later
+      const size_t found = toLoad[i];
+      if ( !fitsIntoPrefetchCap_(attributeInfos_[found]) ) continue;   // read by the accessors then
+      const H5Handle attr(H5Aopen(parent, paths_->component(attributes[found].node()).c_str(), H5P_DEFAULT));
+      if ( !attr.isValid() ) continue;
+      loadValue_(attr, attributeInfos_[found], valueSlots_[found]);
+    }
+  }
+}
+
+std::vector<h5AttributeValue> H5Layout::readAttributes(const std::vector<std::string>& attrNames) {
+  loadAttributeValues(attrNames);
+  std::vector<h5AttributeValue> results(attrNames.size());
+  for (size_t i=0; i<attrNames.size(); ++i) {
+    h5AttributeValue& result = results[i];
+    result.name = attrNames[i];
+    h5Error error;
+    const h5AttributeInfo* info = findAttributeInfo(result.name, error);
+    if ( info ) {
+      result.typeClass = info->typeClass;
+      switch (result.typeClass) {
+        case H5T_STRING :
+          error = tryGetAttributeValue(result.name, result.stringValue);
+          break;
+        case H5T_FLOAT :
+          error = tryGetAttributeValue(result.name, result.realValues);
+          break;
+        case H5T_INTEGER :
+          error = tryGetAttributeValue(result.name, result.intValues);
+          break;
+        default :
+          error = h5Error(h5Error::WrongType, "ERROR - attribute "+result.name+" has an unsupported data type");
+      }
+    }
+    result.error = error.message;
   }
+  return results;
+}
 
-  closeAll({type, attr, parent});
+void H5Layout::getAttributeValue(const std::string& attrName, std::string& value) const {
+  throwIfError(tryGetAttributeValue(attrName, value));
 }
 
-void H5Layout::getAttributeValue(const std::string& attrName, double& value) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
+h5Error H5Layout::tryGetAttributeValue(const std::string& attrName, std::string& value) const {
+  value = "";
+  h5Error error;
+  const h5AttributeInfo* info = findAttributeInfo(attrName, error);
+  if ( !info ) return error;
+  if ( info->typeClass != H5T_STRING ) {
+    return h5Error(h5Error::WrongType, "ERROR - attribute "+attrName+" is not a STRING attribute");
+  }
+  if ( info->isVariableStr ) {
+	  return h5Error(h5Error::VariableLengthString, "WARNING - NON-STANDARD DATA TYPE - attribute "+
+			             attrName+" is a variable-length string attribute,"+
+			             " which is not supported by the ODIM standard.");
   }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
+  size_t sz = info->size;
+  const ValueSlot* slot = valueSlot_(attrName);
+  if ( slot && slot->tag == StringValue ) {
+    const char* str = stringArena_.data()+slot->offset;
+    value.assign(str, std::find(str, str+slot->count, '\0'));
+    sz = slot->count;
+  }
+  else {
+    std::lock_guard<std::recursive_mutex> lock(hdf5Mutex);
+    const H5Handle attr = openAttribute_(attrName, error);
+    if ( !attr.isValid() ) return error;
+    const H5Handle type(H5Aget_type(attr));
+    if ( !type.isValid() ) {
+      return h5Error(h5Error::NotRead, "ERROR - attribute type not found");
+    }
+    std::vector<char> str(sz+1, '\0');
+    auto ret  = H5Aread(attr, type, str.data());
+    if ( ret < 0  ) {
+      return h5Error(h5Error::NotRead, "ERROR - attribute "+attrName+" not read");
+    }
+    value = str.data();
   }
+
+  if ( value.length()+1 != sz ) {
+	  return h5Error(h5Error::WrongStrSize, "WARNING - STRSIZE error - attribute "+
+			             attrName+"`s size is set to "+std::to_string(sz)+", but it should be "+
+                   std::to_string(value.length()+1)+ " (value.length+1) - value is now: "+value);
+  }
+  return error;
+}
+
+void H5Layout::getAttributeValue(const std::string& attrName, double& value) const {
+  throwIfError(tryGetAttributeValue(attrName, value));
+}
+
+h5Error H5Layout::tryGetAttributeValue(const std::string& attrName, double& value) const {
+  h5Error error;
+  const ValueSlot* slot = valueSlot_(attrName);
+  if ( slot && slot->count > 0 ) {
+    if ( slot->tag == RealValues ) {
+      value = realArena_[slot->offset];
+      return error;
+    }
+    if ( slot->tag == IntValues ) {
+      value = static_cast<double>(intArena_[slot->offset]);
+      return error;
+    }
+  }
+  std::lock_guard<std::recursive_mutex> lock(hdf5Mutex);
+  const H5Handle attr = openAttribute_(attrName, error);
+  if ( !attr.isValid() ) return error;
   auto ret  = H5Aread(attr, H5T_NATIVE_DOUBLE, &value);
   if ( ret < 0  ) {
-    closeAll({attr, parent});
-    throw std::runtime_error("ERROR - attribute "+attrName+" not read");
+    return h5Error(h5Error::NotRead, "ERROR - attribute "+attrName+" not read");
   }
-  closeAll({attr, parent});
+  return error;
 }
 
 void H5Layout::getAttributeValue(const std::string& attrName, int64_t& value) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
+  throwIfError(tryGetAttributeValue(attrName, value));
+}
+
+h5Error H5Layout::tryGetAttributeValue(const std::string& attrName, int64_t& value) const {
+  h5Error error;
+  const ValueSlot* slot = valueSlot_(attrName);
+  if ( slot && slot->count > 0 && slot->tag == IntValues ) {
+    value = intArena_[slot->offset];
+    return error;
   }
+  std::lock_guard<std::recursive_mutex> lock(hdf5Mutex);
+  const H5Handle attr = openAttribute_(attrName, error);
+  if ( !attr.isValid() ) return error;
   auto ret  = H5Aread(attr, H5T_NATIVE_INT64, &value);
   if ( ret < 0  ) {
-    closeAll({attr, parent});
-    throw std::runtime_error("ERROR - attribute "+attrName+" not read");
+    return h5Error(h5Error::NotRead, "ERROR - attribute "+attrName+" not read");
   }
-  closeAll({attr, parent});
+  return error;
 }
 
 
 void H5Layout::getAttributeValue(const std::string& attrName, std::vector<double>& values) const {
-  if ( is1DArrayAttribute(attrName) ) {
-    std::string path, name;
-    splitAttributeToPathAndName(attrName, path, name);
-    auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-    if ( parent < 0  ) {
-      throw std::runtime_error("ERROR - node "+path+" not opened");
-    }
-    auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-    if ( attr < 0  ) {
-      H5Oclose(parent);
-      throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-    }
-    auto space = H5Aget_space(attr);
-    hsize_t size=0;
-    H5Sget_simple_extent_dims(space, &size, NULL);
-    values.resize(size, 0.0);
-    auto ret = H5Aread(attr, H5T_NATIVE_DOUBLE, values.data());
-    if ( ret < 0  ) {
-      closeAll({space, attr, parent});
-      throw std::runtime_error("ERROR - attribute "+attrName+" not read");
-    }
-    closeAll({space, attr, parent});
-  }
-  else if ( is2DArrayAttribute(attrName) ) {
-    std::string path, name;
-    splitAttributeToPathAndName(attrName, path, name);
-    auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-    if ( parent < 0  ) {
-      throw std::runtime_error("ERROR - node "+path+" not opened");
+  throwIfError(tryGetAttributeValue(attrName, values));
+}
+
+h5Error H5Layout::tryGetAttributeValue(const std::string& attrName, std::vector<double>& values) const {
+  h5Error error;
+  const h5AttributeInfo* info = findAttributeInfo(attrName, error);
+  if ( !info ) return error;
+  if ( info->rank == 1 || info->rank == 2 ) {
+    const ValueSlot* slot = valueSlot_(attrName);
+    if ( slot && slot->tag == RealValues ) {
+      values.assign(realArena_.begin()+slot->offset, realArena_.begin()+slot->offset+slot->count);
+      return error;
     }
-    auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-    if ( attr < 0  ) {
-      H5Oclose(parent);
-      throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
+    if ( slot && slot->tag == IntValues ) {
+      values.assign(intArena_.begin()+slot->offset, intArena_.begin()+slot->offset+slot->count);
+      return error;
     }
-    auto space = H5Aget_space(attr);
-
-    hsize_t sizes[2];
-    H5Sget_simple_extent_dims(space, sizes, NULL);
-
-    values.resize(sizes[0]*sizes[1], 0.0);
+    std::lock_guard<std::recursive_mutex> lock(hdf5Mutex);
+    const H5Handle attr = openAttribute_(attrName, error);
+    if ( !attr.isValid() ) return error;
+    values.resize(info->numElements(), 0.0);
     auto ret = H5Aread(attr, H5T_NATIVE_DOUBLE, values.data());
     if ( ret < 0  ) {
-      closeAll({space, attr, parent});
-      throw std::runtime_error("ERROR - attribute "+attrName+" not read");
+      return h5Error(h5Error::NotRead, "ERROR - attribute "+attrName+" not read");
     }
-    closeAll({space, attr, parent});
-  }
-  else {
-    values.resize(1);
-    getAttributeValue(attrName, values[0]);
+    return error;
   }
+  values.resize(1);
+  return tryGetAttributeValue(attrName, values[0]);
 }
 
 void H5Layout::getAttributeValue(const std::string& attrName, std::vector<int64_t>& values) const {
-  if ( is1DArrayAttribute(attrName) ) {
-    std::string path, name;
-    splitAttributeToPathAndName(attrName, path, name);
-    auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-    if ( parent < 0  ) {
-      throw std::runtime_error("ERROR - node "+path+" not opened");
-    }
-    auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-    if ( attr < 0  ) {
-      H5Oclose(parent);
-      throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-    }
-    auto space = H5Aget_space(attr);
-    hsize_t size=0;
-    H5Sget_simple_extent_dims(space, &size, NULL);
-    values.resize(size, 0.0);
-    auto ret = H5Aread(attr, H5T_NATIVE_INT64, values.data());
-    if ( ret < 0  ) {
-      closeAll({space, attr, parent});
-      throw std::runtime_error("ERROR - attribute "+attrName+" not read");
+  throwIfError(tryGetAttributeValue(attrName, values));
+}
+
+h5Error H5Layout::tryGetAttributeValue(const std::string& attrName, std::vector<int64_t>& values) const {
+  h5Error error;
+  const h5AttributeInfo* info = findAttributeInfo(attrName, error);
+  if ( !info ) return error;
+  if ( info->rank == 1 || info->rank == 2 ) {
+    const ValueSlot* slot = valueSlot_(attrName);
+    if ( slot && slot->tag == IntValues ) {
+      values.assign(intArena_.begin()+slot->offset, intArena_.begin()+slot->offset+slot->count);
+      return error;
     }
-    closeAll({space, attr, parent});
-  }
-  else if ( is2DArrayAttribute(attrName) ) {
-    std::string path, name;
-    splitAttributeToPathAndName(attrName, path, name);
-    auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-    if ( parent < 0  ) {
-      throw std::runtime_error("ERROR - node "+path+" not opened");
-    }
-    auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-    if ( attr < 0  ) {
-      H5Oclose(parent);
-      throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-    }
-    auto space = H5Aget_space(attr);
-    hsize_t sizes[2];
-    H5Sget_simple_extent_dims(space, sizes, NULL);
-    values.resize(sizes[0]*sizes[1], 0.0);
+    std::lock_guard<std::recursive_mutex> lock(hdf5Mutex);
+    const H5Handle attr = openAttribute_(attrName, error);
+    if ( !attr.isValid() ) return error;
+    values.resize(info->numElements(), 0);
     auto ret = H5Aread(attr, H5T_NATIVE_INT64, values.data());
     if ( ret < 0  ) {
-      closeAll({space, attr, parent});
-      throw std::runtime_error("ERROR - attribute "+attrName+" not read");
+      return h5Error(h5Error::NotRead, "ERROR - attribute "+attrName+" not read");
     }
-    closeAll({space, attr, parent});
-  }
-  else {
-    values.resize(1);
-    getAttributeValue(attrName, values[0]);
+    return error;
   }
+  values.resize(1);
+  return tryGetAttributeValue(attrName, values[0]);
 }
 
 bool H5Layout::isStringAttribute(const std::string& attrName) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto type = H5Aget_type(attr);
-  const bool isString = H5Tget_class(type) == H5T_STRING;
-  closeAll({type, attr, parent});
-  return isString;
+  return attributeInfo(attrName).typeClass == H5T_STRING;
 }
 
 bool H5Layout::isFixedLengthStringAttribute(const std::string& attrName, std::string& errMsg) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto type = H5Aget_type(attr);
-  bool isString = H5Tget_class(type) == H5T_STRING;
-  if ( !isString ) {
-    errMsg = "is not a string";
-    closeAll({type, attr, parent});
-    return isString;
-  }
-  isString = isString && !H5Tis_variable_str(type);
-  if ( !isString ) {
-    errMsg = "is not a fixed length string";
-    closeAll({type, attr, parent});
-    return isString;
-  }
-  isString = isString && H5Tget_strpad(type) == H5T_STR_NULLTERM;
-  if ( !isString ) {
-    errMsg = "is not a H5T_STR_NULLTERM terminated string";
-    closeAll({type, attr, parent});
-    return isString;
-  }
-  return isString;
+  return attributeInfo(attrName).isFixedLengthString(errMsg);
 }
 
 bool H5Layout::isReal64Attribute(const std::string& attrName) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto type = H5Aget_type(attr);
-  bool isReal64{H5Tget_class(type) == H5T_FLOAT && H5Tget_precision(type) == 64};
-  closeAll({type, attr, parent});
-  return isReal64;
+  const h5AttributeInfo& info = attributeInfo(attrName);
+  return info.typeClass == H5T_FLOAT && info.precision == 64;
 }
 
 bool H5Layout::isInt64Attribute(const std::string& attrName) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto type = H5Aget_type(attr);
-  bool isInt64{H5Tget_class(type) == H5T_INTEGER && H5Tget_precision(type) == 64};
-  closeAll({type, attr, parent});
-  return isInt64;
+  const h5AttributeInfo& info = attributeInfo(attrName);
+  return info.typeClass == H5T_INTEGER && info.precision == 64;
 }
 
 bool H5Layout::isBooleanAttribute(const std::string& attrName) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto type = H5Aget_type(attr);
-  bool isBool{H5Tget_class(type) == H5T_NATIVE_HBOOL};
-  closeAll({type, attr, parent});
-  return isBool;
+  return attributeInfo(attrName).typeClass == H5T_NATIVE_HBOOL;
 }
 
 bool H5Layout::isLinkAttribute(const std::string& attrName) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto type = H5Aget_type(attr);
-  bool isBool{H5Tget_class(type) == H5T_REFERENCE};
-  closeAll({type, attr, parent});
-  return isBool;
+  return attributeInfo(attrName).typeClass == H5T_REFERENCE;
 }
 
 bool H5Layout::isUcharDataset(const std::string& dsetName) const {
-  bool isUchar = false;
-  auto dset = H5Dopen(h5FileID_, dsetName.c_str(), H5P_DEFAULT);
-  if ( dset < 0  ) {
+  std::lock_guard<std::recursive_mutex> lock(hdf5Mutex);
+  const H5Handle dset(H5Dopen(h5FileID_, dsetName.c_str(), H5P_DEFAULT));
+  if ( !dset.isValid() ) {
     throw std::runtime_error("ERROR - node "+dsetName+" not opened");
   }
-  auto type = H5Dget_type(dset);
-  isUchar = H5Tget_class(type) == H5T_INTEGER &&
-		        H5Tget_precision(type) == 8 &&
-			      H5Tget_sign(type) == H5T_SGN_NONE;
-  closeAll({type, dset});
-  return isUchar;
+  const H5Handle type(H5Dget_type(dset));
+  return type.isValid() && isUcharType(type);
 }
 
 bool H5Layout::is1DArrayAttribute(const std::string& attrName) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto space = H5Aget_space(attr);
-  auto rank = H5Sget_simple_extent_ndims(space);
-  bool isArray = rank == 1;
-  closeAll({space, attr, parent});
-  return isArray;
+  return attributeInfo(attrName).rank == 1;
 }
 
 bool H5Layout::is2DArrayAttribute(const std::string& attrName) const {
-  std::string path, name;
-  splitAttributeToPathAndName(attrName, path, name);
-  auto parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
-    throw std::runtime_error("ERROR - node "+path+" not opened");
-  }
-  auto attr = H5Aopen(parent, name.c_str(), H5P_DEFAULT);
-  if ( attr < 0  ) {
-    H5Oclose(parent);
-    throw std::runtime_error("ERROR - attribute "+attrName+" not opened");
-  }
-  auto space = H5Aget_space(attr);
-  auto rank = H5Sget_simple_extent_ndims(space);
-  bool is2DArray = rank == 2;
-  closeAll({space, attr, parent});
-  return is2DArray;
+  return attributeInfo(attrName).rank == 2;
 }
 
 void H5Layout::attributeStatistics(const std::string& attrName, double& first, double& last,
@@ -458,17 +661,13 @@ void H5Layout::attributeStatistics(const std::string& attrName, double& first, d
   if ( is1DArrayAttribute(attrName) || is2DArrayAttribute(attrName) ) {
     std::vector<double> values;
     getAttributeValue(attrName, values);
-    first = values.front();
-    last = values.back();
-    min = std::numeric_limits<double>::max();
-    max = std::numeric_limits<double>::lowest();
-    mean = 0.0;
-    for (const double v : values) {
-      if ( v < min ) min = v;
-      if ( v > max ) max = v;
-      mean += v;
-    }
-    mean /= values.size();
+    ArrayStatistics<double> statistics;
+    arrayStatistics(values.data(), values.size(), NEED_ALL, statistics);
+    first = statistics.first;
+    last = statistics.last;
+    min = statistics.min;
+    max = statistics.max;
+    mean = statistics.mean;
   }
   else {
     getAttributeValue(attrName, first);
@@ -481,17 +680,13 @@ void H5Layout::attributeStatistics(const std::string& attrName, int64_t& first,
   if ( is1DArrayAttribute(attrName) ) {
     std::vector<int64_t> values;
     getAttributeValue(attrName, values);
-    first = values.front();
-    last = values.back();
-    min = std::numeric_limits<int64_t>::max();
-    max = std::numeric_limits<int64_t>::lowest();
-    mean = 0.0;
-    for (const int64_t v : values) {
-      if ( v < min ) min = v;
-      if ( v > max ) max = v;
-      mean += v;
-    }
-    mean /= values.size();
+    ArrayStatistics<int64_t> statistics;
+    arrayStatistics(values.data(), values.size(), NEED_ALL, statistics);
+    first = statistics.first;
+    last = statistics.last;
+    min = statistics.min;
+    max = statistics.max;
+    mean = statistics.mean;
   }
   else {
     getAttributeValue(attrName, first);
@@ -516,67 +711,541 @@ void H5Layout::checkAndOpenFile_(const std::string& h5FilePath) {
     throw std::runtime_error{"ERROR - file "+h5FilePath+" is not a HDF5 file"};
   }
   
-  h5FileID_ = H5Fopen(h5FilePath.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);    
+  const H5Handle fapl(createFileAccessPList(ioProfile_));
+  h5FileID_ = H5Fopen(h5FilePath.c_str(), H5F_ACC_RDONLY, fapl);
   if ( h5FileID_ < 0 ) {
     throw std::runtime_error{"ERROR - file "+h5FilePath+" not opened"};
   }
   h5FilePath_ = h5FilePath;
 }
 
+void H5Layout::mapAndOpenFile_(const std::string& h5FilePath) {
+  int fd = open(h5FilePath.c_str(), O_RDONLY);
+  struct stat st;
+  if ( fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0 ) {
+    if ( fd >= 0 ) close(fd);
+    throw std::runtime_error{"ERROR - file "+h5FilePath+" is not a HDF5 file"};
+  }
+  void* mapped = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if ( mapped == MAP_FAILED ) {
+    throw std::runtime_error{"ERROR - file "+h5FilePath+" not opened"};
+  }
+  madvise(mapped, st.st_size, MADV_WILLNEED);
+  mapped_ = mapped;
+  mappedSize_ = st.st_size;
+  checkAndOpenImage_(mapped_, mappedSize_, h5FilePath);
+}
+
+void H5Layout::checkAndOpenImage_(const void* image, const size_t imageSize, const std::string& imageName) {
+  if ( !isHdf5Image(image, imageSize) ) {
+    throw std::runtime_error{"ERROR - file "+imageName+" is not a HDF5 file"};
+  }
+  image_.data = image;
+  image_.size = imageSize;
+  const H5Handle fapl(createImageFapl(&image_));
+  if ( fapl.isValid() ) {
+    // the library identifies the core driver files by name, so each image gets an own one,
+    // not to be confused with the same file opened from the disk or with another image
+    const std::string uniqueName = imageName+"@"+std::to_string(reinterpret_cast<uintptr_t>(image));
+    h5FileID_ = H5Fopen(uniqueName.c_str(), H5F_ACC_RDONLY, fapl);
+  }
+  if ( h5FileID_ < 0 ) {
+    image_ = h5FileImage();
+    throw std::runtime_error{"ERROR - file "+imageName+" not opened"};
+  }
+  h5FilePath_ = imageName;
+}
+
 void H5Layout::findGroupsAndDatasets_() {
-  herr_t status = H5Ovisit(h5FileID_, H5_INDEX_NAME, H5_ITER_NATIVE, fillGroupsAndDatasets, this); //doesn`t work with hdf5 v1.12, but works with -DH5_USE_18_API
+  if ( !targetPrefixes_.empty() ) {
+    isPartial_ = true;
+    std::unordered_set<haddr_t> visited;   // the hard links to an already found object are skipped, as by H5Ovisit
+    if ( isTargeted_("/") ) groups.push_back(h5Entry(paths_.get(), H5PathTrie::ROOT, false));
+    findTargetedGroupsAndDatasets_("/", H5PathTrie::ROOT, visited);
+    return;
+  }
+  ObjectCollector collector{paths_.get(), &groups, &datasets};
+  herr_t status = H5Ovisit(h5FileID_, H5_INDEX_NAME, H5_ITER_NATIVE, fillGroupsAndDatasets, &collector); //doesn`t work with hdf5 v1.12, but works with -DH5_USE_18_API
   if ( status < 0 ) {
     throw std::runtime_error{"ERROR - error while iterating objects in h5FileID_ "+h5FilePath_};
   }
 }
 
+// the same depth-first order as H5Ovisit, but only the subtrees which may contain the targets are entered
+void H5Layout::findTargetedGroupsAndDatasets_(const std::string& groupPath, const uint32_t groupNode,
+                                              std::unordered_set<haddr_t>& visited) {
+  H5Handle group(H5Gopen2(h5FileID_, groupPath.c_str(), H5P_DEFAULT));
+  if ( !group.isValid() ) {
+    throw std::runtime_error{"ERROR - object "+groupPath+" not opened"};
+  }
+  std::vector<std::string> linkNames;
+  herr_t status = H5Literate(group, H5_INDEX_NAME, H5_ITER_INC, NULL, getHardLinkName, &linkNames);
+  group.reset();
+  if ( status < 0 ) {
+    throw std::runtime_error{"ERROR - error while iterating objects in h5FileID_ "+h5FilePath_};
+  }
+  for (const auto& linkName : linkNames) {
+    const std::string objPath = childPrefix(groupPath)+linkName;
+    const bool targeted = isTargeted_(objPath);
+    const bool descend = mayContainTargets_(objPath);
+    if ( !targeted && !descend ) continue;
+    H5O_info_t info;
+    if ( H5Oget_info_by_name(h5FileID_, objPath.c_str(), &info, H5P_DEFAULT) < 0 ) {
+      throw std::runtime_error{"ERROR - object "+objPath+" not opened"};
+    }
+    if ( !visited.insert(info.addr).second ) continue;
+    if ( info.type == H5O_TYPE_GROUP ) {
+      const uint32_t node = paths_->insertChild(groupNode, linkName);
+      if ( targeted ) groups.push_back(h5Entry(paths_.get(), node, false));
+      if ( descend ) findTargetedGroupsAndDatasets_(objPath, node, visited);
+    }
+    else if ( info.type == H5O_TYPE_DATASET && targeted ) {
+      datasets.push_back(h5Entry(paths_.get(), paths_->insertChild(groupNode, linkName), false));
+    }
+  }
+}
+
+// the object itself or any of its attributes may match some target
+bool H5Layout::isTargeted_(const std::string& objPath) const {
+  const std::string attrPrefix = childPrefix(objPath);
+  for (const auto& prefix : targetPrefixes_) {
+    if ( startsWith(objPath, prefix) || startsWith(attrPrefix, prefix) ) return true;
+    if ( startsWith(prefix, attrPrefix) && prefix.find('/', attrPrefix.size()) == std::string::npos ) return true;
+  }
+  return false;
+}
+
+bool H5Layout::mayContainTargets_(const std::string& groupPath) const {
+  const std::string attrPrefix = childPrefix(groupPath);
+  for (const auto& prefix : targetPrefixes_) {
+    if ( startsWith(prefix, attrPrefix) || startsWith(attrPrefix, prefix) ) return true;
+  }
+  return false;
+}
+
 void H5Layout::findAttributes_() {
-  std::vector<std::string> attrNames;
-  for (auto gr : groups) {
-    auto& group = gr.name();
-    attrNames.clear();
-    attrNames = getAttributeNames(group);
-    if ( group.back() != '/' ) group += "/";
-    for (const auto& attrName : attrNames ) attributes.push_back(h5Entry(group+attrName, false));
+  for (const auto& group : groups) collectAttributes_(group);
+  for (const auto& dataset : datasets) collectAttributes_(dataset);
+  if ( prefetchValues_ ) {
+    stringArena_.shrink_to_fit();
+    realArena_.shrink_to_fit();
+    intArena_.shrink_to_fit();
+    valueSlots_.shrink_to_fit();
   }
-  
-  for (auto dset : datasets) {
-    auto& dataset = dset.name();
-    attrNames.clear();
-    attrNames = getAttributeNames(dataset);
-    if ( dataset.back() != '/' ) dataset += "/";
-    for (const auto& attrName : attrNames ) attributes.push_back(h5Entry(dataset+attrName, false));
+}
+
+void H5Layout::collectAttributes_(const h5Entry& objEntry) {
+  forEachAttribute(h5FileID_, objEntry.name(), [&](const std::string& attrName, hid_t attr) {
+    h5AttributeInfo info;
+    fillAttributeInfo(attr, info);
+    if ( prefetchValues_ ) prefetchValue_(attr, info);
+    attributes.push_back(h5Entry(paths_.get(), paths_->insertChild(objEntry.node(), attrName), false));
+    attributeInfos_.push_back(std::move(info));
+  });
+}
+
+void H5Layout::prefetchValue_(hid_t attr, const h5AttributeInfo& info) {
+  ValueSlot slot;
+  loadValue_(attr, info, slot);
+  valueSlots_.push_back(slot);
+}
+
+bool H5Layout::fitsIntoPrefetchCap_(const h5AttributeInfo& info) const {
+  const size_t usedBytes = stringArena_.size() + (realArena_.size()+intArena_.size())*sizeof(double);
+  return usedBytes + info.numElements()*std::max(info.size, sizeof(double)) <= maxPrefetchBytes_;
+}
+
+void H5Layout::loadValue_(hid_t attr, const h5AttributeInfo& info, ValueSlot& slot) {
+  const size_t count = info.numElements();
+  if ( fitsIntoPrefetchCap_(info) && info.rank >= 0 ) {
+    if ( info.typeClass == H5T_STRING && !info.isVariableStr && info.rank == 0 ) {
+      const H5Handle type(H5Aget_type(attr));
+      std::vector<char> buffer(info.size+1, '\0');
+      if ( type.isValid() && H5Aread(attr, type, buffer.data()) >= 0 ) {
+        slot.tag = StringValue;
+        slot.offset = stringArena_.size();
+        slot.count = info.size;
+        stringArena_.append(buffer.data(), info.size);
+      }
+    }
+    else if ( info.typeClass == H5T_FLOAT ) {
+      const size_t offset = realArena_.size();
+      realArena_.resize(offset+count);
+      if ( H5Aread(attr, H5T_NATIVE_DOUBLE, realArena_.data()+offset) >= 0 ) {
+        slot.tag = RealValues;
+        slot.offset = offset;
+        slot.count = count;
+      }
+      else {
+        realArena_.resize(offset);
+      }
+    }
+    else if ( info.typeClass == H5T_INTEGER && !(info.sign == H5T_SGN_NONE && info.precision == 64) ) {
+      const size_t offset = intArena_.size();
+      intArena_.resize(offset+count);
+      if ( H5Aread(attr, H5T_NATIVE_INT64, intArena_.data()+offset) >= 0 ) {
+        slot.tag = IntValues;
+        slot.offset = offset;
+        slot.count = count;
+      }
+      else {
+        intArena_.resize(offset);
+      }
+    }
+  }
+}
+
+// the same values as loadValue_ reads, the rest is left to the library
+void H5Layout::decodeValue_(const h5NativeAttribute& attr, ValueSlot& slot) {
+  const h5AttributeInfo& info = attr.info;
+  if ( !fitsIntoPrefetchCap_(info) || info.rank < 0 ) return;
+  if ( info.typeClass == H5T_STRING && !info.isVariableStr && info.rank == 0 ) {
+    std::string value;
+    if ( !H5NativeReader::decode(attr, value) ) return;
+    slot.tag = StringValue;
+    slot.offset = stringArena_.size();
+    slot.count = value.size();
+    stringArena_.append(value);
+  }
+  else if ( info.typeClass == H5T_FLOAT ) {
+    std::vector<double> values;
+    if ( !H5NativeReader::decode(attr, values) ) return;
+    slot.tag = RealValues;
+    slot.offset = realArena_.size();
+    slot.count = values.size();
+    realArena_.insert(realArena_.end(), values.begin(), values.end());
+  }
+  else if ( info.typeClass == H5T_INTEGER && !(info.sign == H5T_SGN_NONE && info.precision == 64) ) {
+    std::vector<int64_t> values;
+    if ( !H5NativeReader::decode(attr, values) ) return;
+    slot.tag = IntValues;
+    slot.offset = intArena_.size();
+    slot.count = values.size();
+    intArena_.insert(intArena_.end(), values.begin(), values.end());
+  }
+}
+
+const H5Layout::ValueSlot* H5Layout::valueSlot_(const std::string& attrName) const {
+  if ( valueSlots_.empty() ) return nullptr;
+  const size_t found = indexOf_(attributeIndex_, attrName);
+  if ( found == NOT_FOUND ) return nullptr;
+  const ValueSlot& slot = valueSlots_[found];
+  return slot.tag == NotPrefetched ? nullptr : &slot;
+}
+
+void H5Layout::buildIndex_() {
+  groupIndex_.assign(paths_->size(), UINT32_MAX);
+  for (size_t i=0; i<groups.size(); ++i) groupIndex_[groups[i].node()] = i;
+
+  datasetIndex_.assign(paths_->size(), UINT32_MAX);
+  for (size_t i=0; i<datasets.size(); ++i) datasetIndex_[datasets[i].node()] = i;
+
+  attributeIndex_.assign(paths_->size(), UINT32_MAX);
+  for (size_t i=0; i<attributes.size(); ++i) attributeIndex_[attributes[i].node()] = i;
+
+  groupAnchors_ = AnchorIndex();
+  datasetAnchors_ = AnchorIndex();
+  attributeAnchors_ = AnchorIndex();
+}
+
+size_t H5Layout::indexOf_(const std::vector<uint32_t>& index, const std::string& path) const {
+  const uint32_t node = paths_->find(path);
+  if ( node >= index.size() || index[node] == UINT32_MAX ) return NOT_FOUND;
+  return index[node];
+}
+
+// the narrower of the prefix and suffix ranges, filtered by the other anchor
+void H5Layout::candidates_(const std::vector<h5Entry>& entries, AnchorIndex& index,
+                           const std::string& nodeRegex, std::vector<size_t>& indexes) const {
+  indexes.clear();
+  const std::string prefix = literalPrefix(nodeRegex);
+  const std::string suffix = literalSuffix(nodeRegex);
+  if ( prefix.empty() && suffix.empty() ) {
+    for (size_t i=0; i<entries.size(); ++i) indexes.push_back(i);
+    return;
+  }
+  if ( !index.isBuilt ) {
+    buildAnchorIndex(entries, index.byPrefix, index.bySuffix);
+    index.isBuilt = true;
+  }
+
+  std::string name;
+  auto prefixFirst = index.byPrefix.begin();
+  auto prefixLast = index.byPrefix.end();
+  if ( !prefix.empty() ) {
+    prefixFirst = std::partition_point(prefixFirst, prefixLast, [&](const uint32_t i) {
+      entries[i].name(name);
+      return name.compare(0, prefix.size(), prefix) < 0;
+    });
+    prefixLast = std::partition_point(prefixFirst, prefixLast, [&](const uint32_t i) {
+      entries[i].name(name);
+      return name.compare(0, prefix.size(), prefix) == 0;
+    });
+  }
+  auto suffixFirst = index.bySuffix.begin();
+  auto suffixLast = index.bySuffix.end();
+  if ( !suffix.empty() ) {
+    suffixFirst = std::partition_point(suffixFirst, suffixLast, [&](const uint32_t i) {
+      entries[i].name(name);
+      return compareReversed(name, suffix, suffix.size()) < 0;
+    });
+    suffixLast = std::partition_point(suffixFirst, suffixLast, [&](const uint32_t i) {
+      entries[i].name(name);
+      return compareReversed(name, suffix, suffix.size()) == 0;
+    });
+  }
+
+  if ( prefixLast-prefixFirst <= suffixLast-suffixFirst ) {
+    for (auto it=prefixFirst; it!=prefixLast; ++it) {
+      entries[*it].name(name);
+      if ( endsWith(name, suffix) ) indexes.push_back(*it);
+    }
   }
+  else {
+    for (auto it=suffixFirst; it!=suffixLast; ++it) {
+      entries[*it].name(name);
+      if ( startsWith(name, prefix) ) indexes.push_back(*it);
+    }
+  }
+  std::sort(indexes.begin(), indexes.end());
+}
+
+// the returned handle holds an own reference, the cache keeps its one until the eviction
+H5Handle H5Layout::openParent_(const std::string& path) const {
+  auto found = handleIndex_.find(path);
+  if ( found != handleIndex_.end() ) {
+    ++handleCacheHits_;
+    handleList_.splice(handleList_.begin(), handleList_, found->second);
+    H5Iinc_ref(found->second->second);
+    return H5Handle(found->second->second);
+  }
+  ++handleCacheMisses_;
+  hid_t parent = H5Oopen(h5FileID_, path.c_str(), H5P_DEFAULT);
+  if ( parent < 0 || handleCacheSize_ == 0 ) return H5Handle(parent);
+  if ( handleList_.size() >= handleCacheSize_ ) {
+    H5Handle::close(handleList_.back().second);
+    handleIndex_.erase(handleList_.back().first);
+    handleList_.pop_back();
+  }
+  handleList_.emplace_front(path, parent);
+  handleIndex_[path] = handleList_.begin();
+  H5Iinc_ref(parent);
+  return H5Handle(parent);
+}
+
+H5Handle H5Layout::openAttribute_(const std::string& attrName, h5Error& error) const {
+  std::string path, name;
+  splitAttributeToPathAndName(attrName, path, name);
+  const H5Handle parent = openParent_(path);
+  if ( !parent.isValid() ) {
+    error = h5Error(h5Error::NodeNotOpened, "ERROR - node "+path+" not opened");
+    return H5Handle();
+  }
+  H5Handle attr(H5Aopen(parent, name.c_str(), H5P_DEFAULT));
+  if ( !attr.isValid() ) {
+    error = h5Error(h5Error::AttributeNotOpened, "ERROR - attribute "+attrName+" not opened");
+  }
+  return attr;
+}
+
+void H5Layout::clearHandleCache_() const {
+  for (const auto& h : handleList_) H5Handle::close(h.second);
+  handleList_.clear();
+  handleIndex_.clear();
+}
+
+// the snapshot file is named by the device and inode, its content is valid only for the same size, mtime (and hash)
+std::string H5Layout::snapshotKey_(const std::string& h5FilePath, std::string& snapshotPath) const {
+  struct stat st;
+  if ( stat(h5FilePath.c_str(), &st) != 0 ) return "";
+  std::string key = std::to_string(st.st_size)+":"+std::to_string(st.st_mtim.tv_sec)+"."+
+                    std::to_string(st.st_mtim.tv_nsec);
+  if ( snapshotHash_ ) {
+    uint64_t hash;
+    if ( !fnv1aFileHash(h5FilePath, hash) ) return "";
+    key += ":"+std::to_string(hash);
+  }
+  snapshotPath = snapshotDir_+"/"+std::to_string(st.st_dev)+"-"+std::to_string(st.st_ino)+".h5layout";
+  return key;
+}
+
+bool H5Layout::saveSnapshot_(const std::string& snapshotPath, const std::string& key) const {
+  const std::string tmpPath = snapshotPath+".tmp"+std::to_string(getpid());
+  std::ofstream out(tmpPath, std::ios::binary);
+  if ( !out ) return false;
+  out.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  writeValue(out, SNAPSHOT_BYTE_ORDER);
+  writeString(out, key);
+
+  const uint32_t nodes = paths_->size();
+  writeValue(out, nodes);
+  for (uint32_t n=1; n<nodes; ++n) {     // in the insertion order, so the node ids are the same after loading
+    writeValue(out, paths_->parent(n));
+    writeString(out, paths_->component(n));
+  }
+  for (const auto* entries : {&groups, &datasets, &attributes}) {
+    writeValue(out, static_cast<uint64_t>(entries->size()));
+    for (const auto& e : *entries) writeValue(out, e.node());
+  }
+  for (const auto& info : attributeInfos_) {
+    writeValue(out, static_cast<int32_t>(info.typeClass));
+    writeValue(out, static_cast<uint64_t>(info.precision));
+    writeValue(out, static_cast<int32_t>(info.sign));
+    writeValue(out, static_cast<int32_t>(info.strpad));
+    writeValue(out, static_cast<uint8_t>(info.isVariableStr));
+    writeValue(out, static_cast<uint64_t>(info.size));
+    writeValue(out, static_cast<int32_t>(info.rank));
+    writeVector(out, info.dims);
+  }
+  writeValue(out, static_cast<uint64_t>(valueSlots_.size()));
+  for (const auto& slot : valueSlots_) {
+    writeValue(out, static_cast<int32_t>(slot.tag));
+    writeValue(out, static_cast<uint64_t>(slot.offset));
+    writeValue(out, static_cast<uint64_t>(slot.count));
+  }
+  writeString(out, stringArena_);
+  writeVector(out, realArena_);
+  writeVector(out, intArena_);
+  out.close();
+  if ( !out || std::rename(tmpPath.c_str(), snapshotPath.c_str()) != 0 ) {
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool H5Layout::loadSnapshot_(const std::string& snapshotPath, const std::string& key) {
+  std::ifstream in(snapshotPath, std::ios::binary);
+  if ( !in ) return false;
+  char magic[sizeof(SNAPSHOT_MAGIC)];
+  uint32_t byteOrder;
+  std::string snapshotKey;
+  if ( !in.read(magic, sizeof(magic)) || std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+       !readValue(in, byteOrder) || byteOrder != SNAPSHOT_BYTE_ORDER ||
+       !readString(in, snapshotKey) || snapshotKey != key ) {
+    return false;
+  }
+
+  bool ok = true;
+  uint32_t nodes = 0;
+  ok = readValue(in, nodes) && nodes >= 1;
+  std::string component;
+  for (uint32_t n=1; ok && n<nodes; ++n) {
+    uint32_t parent;
+    ok = readValue(in, parent) && parent < n && readString(in, component) &&
+         paths_->insertChild(parent, component) == n;
+  }
+  for (auto* entries : {&groups, &datasets, &attributes}) {
+    uint64_t count = 0;
+    ok = ok && readValue(in, count) && count <= nodes;
+    for (uint64_t i=0; ok && i<count; ++i) {
+      uint32_t node;
+      ok = readValue(in, node) && node < nodes;
+      if ( ok ) entries->push_back(h5Entry(paths_.get(), node, false));
+    }
+  }
+  attributeInfos_.resize(ok ? attributes.size() : 0);
+  for (auto& info : attributeInfos_) {
+    int32_t typeClass, sign, strpad, rank;
+    uint64_t precision, size;
+    uint8_t isVariableStr;
+    ok = ok && readValue(in, typeClass) && readValue(in, precision) && readValue(in, sign) &&
+         readValue(in, strpad) && readValue(in, isVariableStr) && readValue(in, size) &&
+         readValue(in, rank) && readVector(in, info.dims);
+    if ( !ok ) break;
+    info.typeClass = static_cast<H5T_class_t>(typeClass);
+    info.precision = precision;
+    info.sign = static_cast<H5T_sign_t>(sign);
+    info.strpad = static_cast<H5T_str_t>(strpad);
+    info.isVariableStr = isVariableStr != 0;
+    info.size = size;
+    info.rank = rank;
+  }
+  uint64_t slots = 0;
+  ok = ok && readValue(in, slots) && (slots == 0 || slots == attributes.size());
+  valueSlots_.resize(ok ? slots : 0);
+  for (auto& slot : valueSlots_) {
+    int32_t tag;
+    uint64_t offset, count;
+    ok = ok && readValue(in, tag) && readValue(in, offset) && readValue(in, count);
+    if ( !ok ) break;
+    slot.tag = static_cast<ValueTag>(tag);
+    slot.offset = offset;
+    slot.count = count;
+  }
+  ok = ok && readString(in, stringArena_) && readVector(in, realArena_) && readVector(in, intArena_);
+  for (const auto& slot : valueSlots_) {
+    if ( !ok ) break;
+    const size_t arenaSize = slot.tag == StringValue ? stringArena_.size() :
+                             slot.tag == RealValues ? realArena_.size() :
+                             slot.tag == IntValues ? intArena_.size() : 0;
+    ok = slot.tag == NotPrefetched || slot.offset+slot.count <= arenaSize;
+  }
+  if ( !ok ) clearExplored_();
+  return ok;
+}
+
+size_t H5Layout::openObjectCount() const {
+  return h5FileID_ >= 0 ? H5Handle::openObjectCount(h5FileID_) : 0;
 }
 
 void H5Layout::reset_() {
+  clearHandleCache_();
+  handleCacheHits_ = 0;
+  handleCacheMisses_ = 0;
   if ( h5FileID_ > 0 ) {
     H5Fclose(h5FileID_);
   }
   h5FileID_ = -1;
   h5FilePath_ = "";
+  image_ = h5FileImage();
+  if ( mapped_ ) {
+    munmap(mapped_, mappedSize_);
+    mapped_ = nullptr;
+    mappedSize_ = 0;
+  }
+  fromSnapshot_ = false;
+  fromNativeReader_ = false;
+  isPartial_ = false;
+  clearExplored_();
+}
+
+void H5Layout::clearExplored_() {
   groups.clear();
   datasets.clear();
   attributes.clear();
+  attributeInfos_.clear();
+  untargetedInfos_.clear();
+  valueSlots_.clear();
+  stringArena_.clear();
+  realArena_.clear();
+  intArena_.clear();
+  paths_->clear();
+  groupIndex_.clear();
+  datasetIndex_.clear();
+  attributeIndex_.clear();
+  groupAnchors_ = AnchorIndex();
+  datasetAnchors_ = AnchorIndex();
+  attributeAnchors_ = AnchorIndex();
 }
 
 
 herr_t fillGroupsAndDatasets(hid_t loc_id, const char* name, 
-                             const H5O_info_t* info, void* ph5layout) {
+                             const H5O_info_t* info, void* pCollector) {
   if ( loc_id < 0 ) return -1;
-  H5Layout* h5lay = static_cast<H5Layout*>(ph5layout);
-  std::string objName{"/"};
+  ObjectCollector* collector = static_cast<ObjectCollector*>(pCollector);
+  H5PathTrie* paths = collector->paths;
   if (name[0] == '.')  {       /* Root group */
-    h5lay->groups.push_back(h5Entry(objName, false));
+    collector->groups->push_back(h5Entry(paths, H5PathTrie::ROOT, false));
   }
   else {
-    objName += std::string(name);
     switch (info->type) {
       case H5O_TYPE_GROUP:
-        h5lay->groups.push_back(h5Entry(objName, false));
+        collector->groups->push_back(h5Entry(paths, paths->insert("/"+std::string(name)), false));
         break;
       case H5O_TYPE_DATASET:
-        h5lay->datasets.push_back(h5Entry(objName, false));
+        collector->datasets->push_back(h5Entry(paths, paths->insert("/"+std::string(name)), false));
         break;
       case H5O_TYPE_NAMED_DATATYPE:
         break;
@@ -587,6 +1256,106 @@ herr_t fillGroupsAndDatasets(hid_t loc_id, const char* name,
   return 0;
 }
 
+herr_t visitObject(hid_t loc_id, const char* name, const H5O_info_t* info, void* pContext) {
+  if ( loc_id < 0 ) return -1;
+  VisitContext* context = static_cast<VisitContext*>(pContext);
+  const std::string objPath = name[0] == '.' ? "/" : "/"+std::string(name);
+  try {
+    bool visitAttributes = false;
+    if ( info->type == H5O_TYPE_GROUP ) {
+      visitAttributes = context->visitor->visitGroup(objPath);
+    }
+    else if ( info->type == H5O_TYPE_DATASET ) {
+      const H5Handle dset(H5Dopen2(context->file, objPath.c_str(), H5P_DEFAULT));
+      const H5Handle type(dset.isValid() ? H5Dget_type(dset) : -1);
+      const bool isUchar = type.isValid() && isUcharType(type);
+      visitAttributes = context->visitor->visitDataset(objPath, isUchar);
+    }
+    if ( visitAttributes ) {
+      forEachAttribute(context->file, objPath, [&](const std::string& attrName, hid_t attr) {
+        h5AttributeInfo attrInfo;
+        fillAttributeInfo(attr, attrInfo);
+        const std::string attrPath = (objPath == "/" ? objPath : objPath+"/")+attrName;
+        context->visitor->visitAttribute(attrPath, attrInfo, h5AttributeReader(attr, attrPath, attrInfo));
+      });
+    }
+  }
+  catch (...) {
+    context->error = std::current_exception();
+    return -1;
+  }
+  return 0;
+}
+
+// opens the object and each of its attributes in the order of names and closes them after the processing
+void forEachAttribute(hid_t file, const std::string& objPath,
+                      const std::function<void(const std::string&, hid_t)>& process) {
+  const H5Handle object(H5Oopen(file, objPath.c_str(), H5P_DEFAULT));
+  if ( !object.isValid() ) {
+    throw std::runtime_error{"ERROR - object "+objPath+" not opened"};
+  }
+  std::vector<std::string> attrNames;
+  auto status = H5Aiterate2(object, H5_INDEX_NAME, H5_ITER_INC, NULL, getAttributeName, &attrNames);
+  if ( status < 0 ) {
+    throw std::runtime_error{"ERROR - error while iterating attributes in object "+objPath};
+  }
+  for (const auto& attrName : attrNames) {
+    const H5Handle attr(H5Aopen(object, attrName.c_str(), H5P_DEFAULT));
+    if ( !attr.isValid() ) {
+      throw std::runtime_error{"ERROR - attribute "+childPrefix(objPath)+attrName+" not opened"};
+    }
+    process(attrName, attr);
+  }
+}
+
+bool isUcharType(hid_t type) {
+  return H5Tget_class(type) == H5T_INTEGER &&
+         H5Tget_precision(type) == 8 &&
+         H5Tget_sign(type) == H5T_SGN_NONE;
+}
+
+h5AttributeReader::h5AttributeReader(hid_t attr, const std::string& attrName, const h5AttributeInfo& info)
+  : attr_(attr), attrName_(attrName), info_(info) {
+}
+
+void h5AttributeReader::getValue(std::string& value) const {
+  value = "";
+  if ( info_.typeClass != H5T_STRING ) {
+    throw std::runtime_error("ERROR - attribute "+attrName_+" is not a STRING attribute");
+  }
+  if ( info_.isVariableStr ) {
+	  throw std::runtime_error("WARNING - NON-STANDARD DATA TYPE - attribute "+
+			                   attrName_+" is a variable-length string attribute,"+
+			                   " which is not supported by the ODIM standard.");
+  }
+  const H5Handle type(H5Aget_type(attr_));
+  std::vector<char> buffer(info_.size+1, '\0');
+  const herr_t ret = type.isValid() ? H5Aread(attr_, type, buffer.data()) : -1;
+  if ( ret < 0 ) {
+    throw std::runtime_error("ERROR - attribute "+attrName_+" not read");
+  }
+  value.assign(buffer.data(), std::find(buffer.begin(), buffer.begin()+info_.size, '\0')-buffer.begin());
+  if ( value.length()+1 != info_.size ) {
+    throw std::runtime_error("WARNING - STRSIZE error - attribute "+
+                             attrName_+"`s size is set to "+std::to_string(info_.size)+", but it should be "+
+                             std::to_string(value.length()+1)+ " (value.length+1) - value is now: "+value);
+  }
+}
+
+void h5AttributeReader::getValue(std::vector<double>& values) const {
+  values.resize(info_.numElements());
+  if ( H5Aread(attr_, H5T_NATIVE_DOUBLE, values.data()) < 0 ) {
+    throw std::runtime_error("ERROR - attribute "+attrName_+" not read");
+  }
+}
+
+void h5AttributeReader::getValue(std::vector<int64_t>& values) const {
+  values.resize(info_.numElements());
+  if ( H5Aread(attr_, H5T_NATIVE_INT64, values.data()) < 0 ) {
+    throw std::runtime_error("ERROR - attribute "+attrName_+" not read");
+  }
+}
+
 herr_t getAttributeName(hid_t loc_id, const char* name, const H5A_info_t* ainfo, void* pNames) {
   if ( loc_id < 0 || ainfo->data_size <= 0 ) return -1;
   std::vector<std::string>* names = static_cast<std::vector<std::string>*>(pNames);
@@ -594,6 +1363,63 @@ herr_t getAttributeName(hid_t loc_id, const char* name, const H5A_info_t* ainfo,
   return 0;
 }
 
+void fillAttributeInfo(hid_t attr, h5AttributeInfo& info) {
+  const H5Handle type(H5Aget_type(attr));
+  if ( type.isValid() ) {
+    info.typeClass = H5Tget_class(type);
+    info.size = H5Tget_size(type);
+    switch ( info.typeClass ) {
+      case H5T_INTEGER :
+        info.precision = H5Tget_precision(type);
+        info.sign = H5Tget_sign(type);
+        break;
+      case H5T_FLOAT :
+        info.precision = H5Tget_precision(type);
+        break;
+      case H5T_STRING :
+        info.isVariableStr = H5Tis_variable_str(type) > 0;
+        info.strpad = H5Tget_strpad(type);
+        break;
+      default :
+        break;
+    }
+  }
+  const H5Handle space(H5Aget_space(attr));
+  if ( space.isValid() ) {
+    info.rank = H5Sget_simple_extent_ndims(space);
+    if ( info.rank > 0 ) {
+      info.dims.resize(info.rank);
+      H5Sget_simple_extent_dims(space, info.dims.data(), NULL);
+    }
+  }
+}
+
+hsize_t h5AttributeInfo::numElements() const {
+  hsize_t n = 1;
+  for (const auto d : dims) n *= d;
+  return n;
+}
+
+bool h5AttributeInfo::isFixedLengthString(std::string& errMsg) const {
+  if ( typeClass != H5T_STRING ) {
+    errMsg = "is not a string";
+    return false;
+  }
+  if ( isVariableStr ) {
+    errMsg = "is not a fixed length string";
+    return false;
+  }
+  if ( strpad != H5T_STR_NULLTERM ) {
+    errMsg = "is not a H5T_STR_NULLTERM terminated string";
+    return false;
+  }
+  return true;
+}
+
+void throwIfError(const h5Error& error) {
+  if ( error ) throw std::runtime_error(error.message);
+}
+
 void splitAttributeToPathAndName(const std::string& attrName, 
                                  std::string& path, std::string& name) {
   auto found = attrName.find_last_of('/');
@@ -601,10 +1427,204 @@ void splitAttributeToPathAndName(const std::string& attrName,
   name = attrName.substr(found+1);
 }
 
-void closeAll(const std::vector<hid_t>& ids) {
-  for (size_t i=0; i<ids.size(); ++i) {
-    H5Oclose(ids[i]);
+herr_t getHardLinkName(hid_t group, const char* name, const H5L_info_t* info, void* pNames) {
+  if ( group < 0 ) return -1;
+  if ( info->type == H5L_TYPE_HARD ) {
+    static_cast<std::vector<std::string>*>(pNames)->push_back(name);
+  }
+  return 0;
+}
+
+// the literal beginning of a node regex - every path the regex matches starts with it
+std::string literalPrefix(const std::string& nodeRegex) {
+  int depth = 0;
+  for (const char c : nodeRegex) {
+    if ( c == '(' ) ++depth;
+    else if ( c == ')' ) --depth;
+    else if ( c == '|' && depth == 0 ) return "";   // a top level alternative may start with anything
+  }
+  static const std::string special = ".[]{}()*+?^$|\\";
+  std::string prefix;
+  for (const char c : nodeRegex) {
+    if ( special.find(c) == std::string::npos ) {
+      prefix += c;
+      continue;
+    }
+    if ( (c == '*' || c == '?' || c == '{') && !prefix.empty() ) {   // the previous character is optional
+      prefix.pop_back();
+    }
+    break;
+  }
+  return prefix;
+}
+
+// the literal end of the regex, conservatively - an escaped character ends it
+std::string literalSuffix(const std::string& nodeRegex) {
+  int depth = 0;
+  for (const char c : nodeRegex) {
+    if ( c == '(' ) ++depth;
+    else if ( c == ')' ) --depth;
+    else if ( c == '|' && depth == 0 ) return "";
+  }
+  static const std::string special = ".[]{}()*+?^$|\\";
+  size_t begin = nodeRegex.size();
+  while ( begin > 0 && special.find(nodeRegex[begin-1]) == std::string::npos ) {
+    if ( begin > 1 && nodeRegex[begin-2] == '\\' ) break;    // \d, \w, ...
+    --begin;
+  }
+  return nodeRegex.substr(begin);
+}
+
+std::string childPrefix(const std::string& objPath) {
+  return objPath.back() == '/' ? objPath : objPath+"/";
+}
+
+bool startsWith(const std::string& str, const std::string& prefix) {
+  return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool endsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() && str.compare(str.size()-suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// compares up to n last characters of a and b from the end, as std::string compares from the front
+int compareReversed(const std::string& a, const std::string& b, const size_t n) {
+  const size_t la = std::min(a.size(), n);
+  const size_t lb = std::min(b.size(), n);
+  for (size_t k=0; k<la && k<lb; ++k) {
+    const unsigned char ca = a[a.size()-1-k];
+    const unsigned char cb = b[b.size()-1-k];
+    if ( ca != cb ) return ca < cb ? -1 : 1;
+  }
+  return la < lb ? -1 : (la > lb ? 1 : 0);
+}
+
+void buildAnchorIndex(const std::vector<h5Entry>& entries, std::vector<uint32_t>& byPrefix,
+                      std::vector<uint32_t>& bySuffix) {
+  std::vector<std::string> names(entries.size());
+  for (size_t i=0; i<entries.size(); ++i) entries[i].name(names[i]);
+  byPrefix.resize(entries.size());
+  for (size_t i=0; i<entries.size(); ++i) byPrefix[i] = i;
+  bySuffix = byPrefix;
+  std::sort(byPrefix.begin(), byPrefix.end(), [&](const uint32_t a, const uint32_t b) {
+    return names[a] < names[b];
+  });
+  std::sort(bySuffix.begin(), bySuffix.end(), [&](const uint32_t a, const uint32_t b) {
+    return compareReversed(names[a], names[b], SIZE_MAX) < 0;
+  });
+}
+
+bool fnv1aFileHash(const std::string& filePath, uint64_t& hash) {
+  FILE* f = fopen(filePath.c_str(), "rb");
+  if ( !f ) return false;
+  hash = 14695981039346656037ULL;
+  std::vector<unsigned char> buffer(1<<20);
+  size_t n;
+  while ( (n = fread(buffer.data(), 1, buffer.size(), f)) > 0 ) {
+    for (size_t i=0; i<n; ++i) {
+      hash ^= buffer[i];
+      hash *= 1099511628211ULL;
+    }
+  }
+  const bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+template <typename T> void writeValue(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T> bool readValue(std::istream& in, T& value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+void writeString(std::ostream& out, const std::string& str) {
+  writeValue(out, static_cast<uint64_t>(str.size()));
+  out.write(str.data(), str.size());
+}
+
+bool readString(std::istream& in, std::string& str) {
+  uint64_t size;
+  if ( !readValue(in, size) || size > (1ULL<<32) ) return false;
+  str.resize(size);
+  return size == 0 || static_cast<bool>(in.read(&str[0], size));
+}
+
+template <typename T> void writeVector(std::ostream& out, const std::vector<T>& v) {
+  writeValue(out, static_cast<uint64_t>(v.size()));
+  out.write(reinterpret_cast<const char*>(v.data()), v.size()*sizeof(T));
+}
+
+template <typename T> bool readVector(std::istream& in, std::vector<T>& v) {
+  uint64_t size;
+  if ( !readValue(in, size) || size > (1ULL<<32)/sizeof(T) ) return false;
+  v.resize(size);
+  return size == 0 || static_cast<bool>(in.read(reinterpret_cast<char*>(v.data()), size*sizeof(T)));
+}
+
+bool isHdf5Image(const void* image, const size_t imageSize) {
+  static const char signature[] = "\211HDF\r\n\032\n";
+  if ( !image ) return false;
+  const char* bytes = static_cast<const char*>(image);
+  for (size_t offset=0; offset+8<=imageSize; offset = offset ? offset*2 : 512) {   // the superblock is at 0, 512, 1024, 2048, ...
+    if ( std::memcmp(bytes+offset, signature, 8) == 0 ) return true;
+  }
+  return false;
+}
+
+// file image callbacks in the manner of H5LTopen_file_image with H5LT_FILE_IMAGE_DONT_COPY - 
+// the library gets the caller`s buffer itself, which is only read, never resized or freed
+static void* imageMalloc(size_t size, H5FD_file_image_op_t op, void* pImage) {
+  h5FileImage* image = static_cast<h5FileImage*>(pImage);
+  if ( size != image->size ) return NULL;
+  switch (op) {
+    case H5FD_FILE_IMAGE_OP_PROPERTY_LIST_SET:
+    case H5FD_FILE_IMAGE_OP_PROPERTY_LIST_COPY:
+    case H5FD_FILE_IMAGE_OP_PROPERTY_LIST_GET:
+    case H5FD_FILE_IMAGE_OP_FILE_OPEN:
+      return const_cast<void*>(image->data);
+    default:
+      return NULL;
+  }
+}
+
+static void* imageMemcpy(void* dest, const void* src, size_t size, H5FD_file_image_op_t op, void* pImage) {
+  h5FileImage* image = static_cast<h5FileImage*>(pImage);
+  if ( dest != image->data || src != image->data || size != image->size ) return NULL;
+  if ( op == H5FD_FILE_IMAGE_OP_FILE_RESIZE ) return NULL;
+  return dest;
+}
+
+static void* imageRealloc(void*, size_t, H5FD_file_image_op_t, void*) {
+  return NULL;
+}
+
+static herr_t imageFree(void*, H5FD_file_image_op_t, void*) {
+  return 0;
+}
+
+static void* imageUdataCopy(void* pImage) {
+  return pImage;
+}
+
+static herr_t imageUdataFree(void*) {
+  return 0;
+}
+
+hid_t createImageFapl(void* pImage) {
+  hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+  if ( fapl < 0 ) return -1;
+  H5FD_file_image_callbacks_t callbacks = {imageMalloc, imageMemcpy, imageRealloc, imageFree,
+                                           imageUdataCopy, imageUdataFree, pImage};
+  h5FileImage* image = static_cast<h5FileImage*>(pImage);
+  if ( H5Pset_fapl_core(fapl, 64*1024, 0) < 0 ||
+       H5Pset_file_image_callbacks(fapl, &callbacks) < 0 ||
+       H5Pset_file_image(fapl, const_cast<void*>(image->data), image->size) < 0 ) {
+    H5Pclose(fapl);
+    return -1;
   }
+  return fapl;
 }
 
 } // end namespace myh5
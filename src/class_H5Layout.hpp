@@ -8,42 +8,161 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <unordered_map>
+#include <unordered_set>
+#include <list>
+#include <memory>
+#include <functional>
 #include <hdf5.h>
 #include <stdint.h>
+#include "class_H5PathTrie.hpp"
+#include "class_H5Handle.hpp"
 
 namespace myodim {
 
-struct h5Entry: public std::pair<std::string, bool>  {   // need to use to save wether it was checked or not, it speeds up the checking of extra features a lot
+// need to use to save wether it was checked or not, it speeds up the checking of extra features a lot;
+// it is no more the std::pair<std::string, bool> of the path and the flag and it can`t be made from a path string -
+// it points to a node in the paths() trie of its H5Layout and is valid only while that layout exists
+struct h5Entry {
   public:
     h5Entry() = default;
-    h5Entry(const std::string& str, const bool b): std::pair<std::string, bool>(str,b) {};
-    std::string& name() {return first;};
-    std::string name() const {return first;};
-    bool& wasFound() {return second;};
-    bool wasFound() const {return second;};
+    h5Entry(const H5PathTrie* paths, const uint32_t node, const bool b): paths_(paths), node_(node), found_(b) {};
+    std::string name() const {return paths_ ? paths_->path(node_) : "";};   // the full path is made on demand
+    void name(std::string& nameStr) const {paths_->path(node_, nameStr);};   // reuses the nameStr buffer
+    uint32_t node() const {return node_;};
+    bool& wasFound() {return found_;};
+    bool wasFound() const {return found_;};
+  private:
+    const H5PathTrie* paths_{nullptr};
+    uint32_t node_{H5PathTrie::NO_NODE};
+    bool found_{false};
+};
+
+struct h5AttributeInfo {   // type and space of an attribute, recorded once in explore, so the type checks need no HDF5 call
+  H5T_class_t typeClass{H5T_NO_CLASS};
+  size_t precision{0};
+  H5T_sign_t sign{H5T_SGN_ERROR};
+  H5T_str_t strpad{H5T_STR_ERROR};
+  bool isVariableStr{false};
+  size_t size{0};                 // storage size of one element in bytes
+  int rank{-1};                   // 0 for scalars
+  std::vector<hsize_t> dims;
+  hsize_t numElements() const;
+  bool isFixedLengthString(std::string& errMsg) const;   // the ODIM string type, errMsg says why not
 };
 
+struct h5Error {   // outcome of the non-throwing accessors, the message is what the throwing ones throw
+  enum Kind { None, NodeNotOpened, AttributeNotOpened, NotRead, WrongType, VariableLengthString, WrongStrSize };
+  Kind kind{None};
+  std::string message{""};
+  h5Error() = default;
+  h5Error(const Kind k, const std::string& msg): kind(k), message(msg) {};
+  bool isWarning() const {return kind == VariableLengthString || kind == WrongStrSize;};  // a non-standard, but readable attribute
+  explicit operator bool() const {return kind != None;};
+};
+
+class h5AttributeReader {   // reads the value of the visited attribute, valid only inside H5LayoutVisitor::visitAttribute
+  public:
+    h5AttributeReader(hid_t attr, const std::string& attrName, const h5AttributeInfo& info);
+    void getValue(std::string& value) const;
+    void getValue(std::vector<double>& values) const;
+    void getValue(std::vector<int64_t>& values) const;
+  private:
+    hid_t attr_;
+    const std::string& attrName_;
+    const h5AttributeInfo& info_;
+};
+
+class H5LayoutVisitor {   // gets the objects in the order they are found by H5Layout::visit, nothing is stored
+  public:
+    virtual ~H5LayoutVisitor() {};
+    virtual bool visitGroup(const std::string&) {return true;};              // false - skip the attributes of the group
+    virtual bool visitDataset(const std::string&, const bool /*isUchar*/) {return true;};
+    virtual void visitAttribute(const std::string&, const h5AttributeInfo&, const h5AttributeReader&) {};
+};
+
+struct h5AttributeValue {   // a typed result of H5Layout::readAttributes
+  std::string name;
+  H5T_class_t typeClass{H5T_NO_CLASS};
+  std::string stringValue;
+  std::vector<double> realValues;
+  std::vector<int64_t> intValues;
+  std::string error;          // the message of the failed read, empty when the value was read
+};
+
+struct h5FileImage {   // an in-memory file image handed to the core driver without copying
+  const void* data{nullptr};
+  size_t size{0};
+};
+
+struct h5NativeAttribute;   // class_H5NativeReader.hpp
+
 class H5Layout {
   public:
+    static const size_t DEFAULT_MAX_PREFETCH_BYTES = 64*1024*1024;
+    static const size_t DEFAULT_HANDLE_CACHE_SIZE = 16;
+    static const size_t NOT_FOUND = SIZE_MAX;
+
     std::vector<h5Entry> groups;
     std::vector<h5Entry> datasets;
     std::vector<h5Entry> attributes;
     
     H5Layout();
     H5Layout(const std::string& h5FilePath);
+    H5Layout(const void* image, const size_t imageSize, const std::string& imageName);
     ~H5Layout();
+    H5Layout(const H5Layout&) = delete;              // the entries point to the paths trie and the handles are owned,
+    H5Layout& operator=(const H5Layout&) = delete;   // so a layout is neither copied nor moved
     
     void explore(const std::string& h5FilePath);
+    const H5PathTrie& paths() const;    // the paths of all the groups, datasets and attributes
+    void explore(const std::string& h5FilePath, const std::vector<std::string>& targets);   // the targets of this call only
+    void setExploreTargets(const std::vector<std::string>& targets);  // node paths or regexes, empty for the whole file
+    void visit(const std::string& h5FilePath, H5LayoutVisitor& visitor);   // streams the file content, the layout stays empty
+    void exploreImage(const void* image, const size_t imageSize, const std::string& imageName);  // the image must stay valid while the layout is used
+    void setValuePrefetch(const bool prefetch, const size_t maxBytes=DEFAULT_MAX_PREFETCH_BYTES);
+    size_t prefetchedValuesBytes() const;
+    void setSnapshotCache(const std::string& cacheDir, const bool useContentHash=false);   // empty cacheDir turns it off
+    bool isFromSnapshot() const;
+    void setMmap(const bool useMmap);
+    void setNativeReader(const bool useNativeReader);   // explore by the built-in metadata reader, libhdf5 only for the rest
+    bool isFromNativeReader() const;
+    void setIoProfile(const std::string& ioProfile);   // file access profile of module_FileAccess, used by explore()
+    double metadataCacheHitRate() const;              // of the opened file, -1 if not available
+    void setHandleCacheSize(const size_t size);
+    size_t handleCacheHits() const;
+    size_t handleCacheMisses() const;
+    size_t openObjectCount() const;   // open identifiers of the file incl. itself and the cached handles, for leak checks
     bool hasAttribute(const std::string& attrName) const;
     bool hasGroup(const std::string& groupName) const;
     bool hasDataset(const std::string& dsetName) const;
+    size_t findGroup(const std::string& groupName) const;     // index in groups, NOT_FOUND if not there
+    size_t findDataset(const std::string& dsetName) const;
+    size_t findAttribute(const std::string& attrName) const;
+    // indexes of the entries which may match the node regex - those with its literal prefix and suffix, ascending
+    void candidateGroups(const std::string& nodeRegex, std::vector<size_t>& indexes) const;
+    void candidateDatasets(const std::string& nodeRegex, std::vector<size_t>& indexes) const;
+    void candidateAttributes(const std::string& nodeRegex, std::vector<size_t>& indexes) const;
     std::string filePath() const;
     std::vector<std::string> getAttributeNames(const std::string& objPath) const;
+    const h5AttributeInfo& attributeInfo(const std::string& attrName) const;
+    const h5AttributeInfo& attributeInfoAt(const size_t index) const;   // of attributes[index], no path lookup
+    // nullptr when missing; after a targeted explore the attributes outside the targets are read from the file
+    const h5AttributeInfo* findAttributeInfo(const std::string& attrName, h5Error& error) const;
+    // batched read into the value cache, each parent opened once, up to the maxBytes of setValuePrefetch
+    void loadAttributeValues(const std::vector<std::string>& attrNames);
+    std::vector<h5AttributeValue> readAttributes(const std::vector<std::string>& attrNames);  // in the order of attrNames
     void getAttributeValue(const std::string& attrName, std::string& value) const;
     void getAttributeValue(const std::string& attrName, double& value) const;
     void getAttributeValue(const std::string& attrName, int64_t& value) const;
     void getAttributeValue(const std::string& attrName, std::vector<double>& values) const;
     void getAttributeValue(const std::string& attrName, std::vector<int64_t>& values) const;
+    // the same without exceptions - the value is set also with the STRSIZE warning
+    h5Error tryGetAttributeValue(const std::string& attrName, std::string& value) const;
+    h5Error tryGetAttributeValue(const std::string& attrName, double& value) const;
+    h5Error tryGetAttributeValue(const std::string& attrName, int64_t& value) const;
+    h5Error tryGetAttributeValue(const std::string& attrName, std::vector<double>& values) const;
+    h5Error tryGetAttributeValue(const std::string& attrName, std::vector<int64_t>& values) const;
     bool isStringAttribute(const std::string& attrName) const;
     bool isFixedLengthStringAttribute(const std::string& attrName, std::string& errMsg) const;
     bool isReal64Attribute(const std::string& attrName) const;
@@ -62,9 +181,85 @@ class H5Layout {
   private:
     std::string h5FilePath_{""};
     hid_t h5FileID_{-1};
+    h5FileImage image_;
+    bool useMmap_{false};
+    bool useNativeReader_{false};
+    bool fromNativeReader_{false};
+    std::string snapshotDir_{""};     // explored layouts are saved there and loaded instead of exploring again
+    bool snapshotHash_{false};
+    bool fromSnapshot_{false};
+    std::string ioProfile_{"default"};
+    std::vector<std::string> targetPrefixes_;   // literal prefixes of the explore targets, empty when exploring all
+    bool isPartial_{false};                     // explored with targets, the other attributes are read on demand
+    void* mapped_{nullptr};        // the mmap-ed file in the mmap mode, owned by the layout
+    size_t mappedSize_{0};
+    std::unique_ptr<H5PathTrie> paths_{new H5PathTrie};   // the entries keep a pointer to it
+    std::vector<uint32_t> groupIndex_;       // path trie node -> position in groups, built once in explore
+    std::vector<uint32_t> datasetIndex_;     // the wasFound flag is not part of the key
+    std::vector<uint32_t> attributeIndex_;
+    size_t indexOf_(const std::vector<uint32_t>& index, const std::string& path) const;
+    struct AnchorIndex {                     // positions sorted by the path and by the reversed path, built on first use
+      std::vector<uint32_t> byPrefix;
+      std::vector<uint32_t> bySuffix;
+      bool isBuilt{false};
+    };
+    mutable AnchorIndex groupAnchors_;
+    mutable AnchorIndex datasetAnchors_;
+    mutable AnchorIndex attributeAnchors_;
+    void candidates_(const std::vector<h5Entry>& entries, AnchorIndex& index,
+                     const std::string& nodeRegex, std::vector<size_t>& indexes) const;
+    std::vector<h5AttributeInfo> attributeInfos_;          // parallel to attributes
+    mutable std::unordered_map<std::string, h5AttributeInfo> untargetedInfos_;   // read on demand after a targeted explore
+
+    // the optional prefetched attribute values - a tagged slot per attribute pointing into typed arenas
+    enum ValueTag { NotPrefetched, StringValue, RealValues, IntValues };
+    struct ValueSlot {
+      ValueTag tag{NotPrefetched};
+      size_t offset{0};
+      size_t count{0};
+    };
+    bool prefetchValues_{false};
+    size_t maxPrefetchBytes_{DEFAULT_MAX_PREFETCH_BYTES};
+    std::vector<ValueSlot> valueSlots_;                    // parallel to attributes when prefetching
+    std::string stringArena_;
+    std::vector<double> realArena_;
+    std::vector<int64_t> intArena_;
+
+    // LRU cache of open parent object handles used by the attribute accessors, most recent first
+    typedef std::list< std::pair<std::string, hid_t> > HandleList;
+    size_t handleCacheSize_{DEFAULT_HANDLE_CACHE_SIZE};
+    mutable HandleList handleList_;
+    mutable std::unordered_map<std::string, HandleList::iterator> handleIndex_;
+    mutable size_t handleCacheHits_{0};
+    mutable size_t handleCacheMisses_{0};
+    H5Handle openParent_(const std::string& path) const;
+    H5Handle openAttribute_(const std::string& attrName, h5Error& error) const;
+    const h5AttributeInfo* untargetedAttributeInfo_(const std::string& attrName, h5Error& error) const;
+    void clearHandleCache_() const;
+
+    const ValueSlot* valueSlot_(const std::string& attrName) const;
+    void prefetchValue_(hid_t attr, const h5AttributeInfo& info);
+    void loadValue_(hid_t attr, const h5AttributeInfo& info, ValueSlot& slot);
+    void decodeValue_(const h5NativeAttribute& attr, ValueSlot& slot);
+    bool fitsIntoPrefetchCap_(const h5AttributeInfo& info) const;
     void checkAndOpenFile_(const std::string& h5FilePath);
+    void mapAndOpenFile_(const std::string& h5FilePath);
+    void checkAndOpenImage_(const void* image, const size_t imageSize, const std::string& imageName);
+    void exploreOpened_();
+    void exploreAll_();
+    bool exploreNative_();
+    std::string snapshotKey_(const std::string& h5FilePath, std::string& snapshotPath) const;
+    bool loadSnapshot_(const std::string& snapshotPath, const std::string& key);
+    bool saveSnapshot_(const std::string& snapshotPath, const std::string& key) const;
+    void clearExplored_();
     void findGroupsAndDatasets_();
+    void findTargetedGroupsAndDatasets_(const std::string& groupPath, const uint32_t groupNode,
+                                        std::unordered_set<haddr_t>& visited);
+    bool isTargeted_(const std::string& objPath) const;
+    bool mayContainTargets_(const std::string& groupPath) const;
     void findAttributes_();
+    void collectAttributes_(const h5Entry& object);
+    void buildIndex_();
     void reset_();
 };
 
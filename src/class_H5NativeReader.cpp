@@ -0,0 +1,496 @@
+// class_H5NativeReader.cpp
+// reader of the hdf5 metadata subset used by the ODIM-H5 files, working directly on the file image
+// Ladislav Meri, SHMU
+
+#include "class_H5NativeReader.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+namespace myodim {
+
+static const unsigned char HDF5_SIGNATURE[8] = {0x89, 'H', 'D', 'F', '\r', '\n', 0x1a, '\n'};
+
+// object header message types
+static const unsigned MSG_NIL = 0x00;
+static const unsigned MSG_DATASPACE = 0x01;
+static const unsigned MSG_LINK_INFO = 0x02;
+static const unsigned MSG_DATATYPE = 0x03;
+static const unsigned MSG_LINK = 0x06;
+static const unsigned MSG_ATTRIBUTE = 0x0C;
+static const unsigned MSG_CONTINUATION = 0x10;
+static const unsigned MSG_SYMBOL_TABLE = 0x11;
+static const unsigned MSG_ATTRIBUTE_INFO = 0x15;
+static const unsigned MSG_FLAG_SHARED = 0x02;
+
+static const int MAX_BTREE_DEPTH = 64;
+
+static uint64_t pad8(const uint64_t n);
+static uint64_t readRaw(const unsigned char* p, const unsigned bytes, const bool bigEndian);
+
+H5NativeReader::H5NativeReader(const void* image, const size_t imageSize)
+  : image_(static_cast<const unsigned char*>(image)), size_(imageSize) {
+}
+
+const std::string& H5NativeReader::unsupported() const {
+  return unsupported_;
+}
+
+bool H5NativeReader::read(std::vector<h5NativeObject>& objects) {
+  objects.clear();
+  visited_.clear();
+  unsupported_ = "";
+  try {
+    const uint64_t rootAddress = readSuperblock_();
+    visitObject_(rootAddress, UINT32_MAX, "", objects);
+  }
+  catch (const std::exception& e) {
+    unsupported_ = e.what();
+    objects.clear();
+    return false;
+  }
+  return true;
+}
+
+bool H5NativeReader::decode(const h5NativeAttribute& attr, std::string& value) {
+  const h5AttributeInfo& info = attr.info;
+  if ( !attr.data || info.typeClass != H5T_STRING || info.isVariableStr || info.rank != 0 ) return false;
+  value.assign(reinterpret_cast<const char*>(attr.data), info.size);
+  return true;
+}
+
+bool H5NativeReader::decode(const h5NativeAttribute& attr, std::vector<double>& values) {
+  const h5AttributeInfo& info = attr.info;
+  if ( !attr.data || info.typeClass != H5T_FLOAT ) return false;
+  values.resize(info.numElements());
+  for (size_t i=0; i<values.size(); ++i) {
+    const uint64_t bits = readRaw(attr.data+i*info.size, info.size, attr.bigEndian);
+    if ( info.size == 4 ) {
+      const uint32_t bits32 = static_cast<uint32_t>(bits);
+      float f;
+      std::memcpy(&f, &bits32, sizeof(f));
+      values[i] = f;
+    }
+    else {
+      std::memcpy(&values[i], &bits, sizeof(double));
+    }
+  }
+  return true;
+}
+
+bool H5NativeReader::decode(const h5NativeAttribute& attr, std::vector<int64_t>& values) {
+  const h5AttributeInfo& info = attr.info;
+  if ( !attr.data || info.typeClass != H5T_INTEGER ) return false;
+  values.resize(info.numElements());
+  const unsigned bits = 8*info.size;
+  for (size_t i=0; i<values.size(); ++i) {
+    uint64_t raw = readRaw(attr.data+i*info.size, info.size, attr.bigEndian);
+    if ( info.sign == H5T_SGN_2 && bits < 64 && (raw >> (bits-1)) & 1 ) {
+      raw |= ~UINT64_C(0) << bits;   // sign extension
+    }
+    values[i] = static_cast<int64_t>(raw);
+  }
+  return true;
+}
+
+uint64_t H5NativeReader::readUint_(const uint64_t pos, const unsigned bytes) const {
+  return readRaw(at_(pos, bytes), bytes, false);
+}
+
+uint64_t H5NativeReader::readAddress_(const uint64_t pos) const {
+  return readUint_(pos, offsetSize_);
+}
+
+uint64_t H5NativeReader::readLength_(const uint64_t pos) const {
+  return readUint_(pos, lengthSize_);
+}
+
+const unsigned char* H5NativeReader::at_(const uint64_t pos, const uint64_t bytes) const {
+  if ( pos > size_ || bytes > size_-pos ) {
+    throw std::runtime_error{"reading beyond the end of the file"};
+  }
+  return image_+pos;
+}
+
+bool H5NativeReader::isUndefined_(const uint64_t address) const {
+  return offsetSize_ == 8 ? address == ~UINT64_C(0) : address == (UINT64_C(1) << 8*offsetSize_)-1;
+}
+
+bool H5NativeReader::hasSignature_(const uint64_t pos, const char* signature) const {
+  return pos <= size_ && size_-pos >= 4 && std::memcmp(image_+pos, signature, 4) == 0;
+}
+
+// returns the address of the root group object header
+uint64_t H5NativeReader::readSuperblock_() {
+  uint64_t pos = 0;
+  while ( pos+8 <= size_ && std::memcmp(image_+pos, HDF5_SIGNATURE, 8) != 0 ) {
+    pos = pos == 0 ? 512 : 2*pos;
+  }
+  if ( pos+8 > size_ ) throw std::runtime_error{"no superblock"};
+  const unsigned version = *at_(pos+8, 1);
+  if ( version > 1 ) {
+    throw std::runtime_error{"superblock version "+std::to_string(version)};
+  }
+  offsetSize_ = *at_(pos+13, 1);
+  lengthSize_ = *at_(pos+14, 1);
+  if ( (offsetSize_ != 2 && offsetSize_ != 4 && offsetSize_ != 8) ||
+       (lengthSize_ != 2 && lengthSize_ != 4 && lengthSize_ != 8) ) {
+    throw std::runtime_error{"size of offsets "+std::to_string(offsetSize_)};
+  }
+  pos += version == 0 ? 24 : 28;
+  base_ = readAddress_(pos);
+  pos += 4*offsetSize_;            // base, free-space, end of file and driver info addresses
+  return readAddress_(pos+offsetSize_);    // the root symbol table entry: link name offset, object header address, ...
+}
+
+void H5NativeReader::readObjectHeader_(const uint64_t address, std::vector<Message>& messages) const {
+  messages.clear();
+  std::vector< std::pair<uint64_t, uint64_t> > continuations;
+  const uint64_t pos = base_+address;
+  bool isV2 = false;
+  bool hasCreationOrder = false;
+  if ( hasSignature_(pos, "OHDR") ) {
+    const unsigned version = *at_(pos+4, 1);
+    if ( version != 2 ) throw std::runtime_error{"object header version "+std::to_string(version)};
+    const unsigned flags = *at_(pos+5, 1);
+    hasCreationOrder = flags & 0x04;
+    uint64_t p = pos+6;
+    if ( flags & 0x20 ) p += 16;   // times
+    if ( flags & 0x10 ) p += 4;    // attribute phase change values
+    const unsigned sizeBytes = 1u << (flags & 0x03);
+    const uint64_t chunkSize = readUint_(p, sizeBytes);
+    p += sizeBytes;
+    readV2Messages_(p, p+chunkSize, hasCreationOrder, messages, continuations);
+    isV2 = true;
+  }
+  else {
+    const unsigned version = *at_(pos, 1);
+    if ( version != 1 ) throw std::runtime_error{"object header version "+std::to_string(version)};
+    const uint64_t chunkSize = readUint_(pos+8, 4);
+    readV1Messages_(pos+16, pos+16+chunkSize, messages, continuations);
+  }
+  for (size_t i=0; i<continuations.size(); ++i) {
+    const uint64_t p = base_+continuations[i].first;
+    const uint64_t length = continuations[i].second;
+    if ( isV2 ) {
+      if ( !hasSignature_(p, "OCHK") || length < 8 ) throw std::runtime_error{"object header continuation"};
+      readV2Messages_(p+4, p+length-4, hasCreationOrder, messages, continuations);   // without the checksum
+    }
+    else {
+      readV1Messages_(p, p+length, messages, continuations);
+    }
+    if ( continuations.size() > 1024 ) throw std::runtime_error{"object header continuations"};
+  }
+}
+
+void H5NativeReader::readV1Messages_(uint64_t pos, const uint64_t end, std::vector<Message>& messages,
+                                     std::vector< std::pair<uint64_t, uint64_t> >& continuations) const {
+  at_(pos, end-pos);
+  while ( pos+8 <= end ) {
+    Message msg;
+    msg.type = readUint_(pos, 2);
+    msg.size = readUint_(pos+2, 2);
+    msg.flags = *at_(pos+4, 1);
+    msg.pos = pos+8;
+    if ( msg.pos+msg.size > end ) throw std::runtime_error{"object header message size"};
+    if ( msg.type == MSG_CONTINUATION ) {
+      continuations.emplace_back(readAddress_(msg.pos), readLength_(msg.pos+offsetSize_));
+    }
+    else if ( msg.type != MSG_NIL ) {
+      messages.push_back(msg);
+    }
+    pos = msg.pos+msg.size;
+  }
+}
+
+void H5NativeReader::readV2Messages_(uint64_t pos, const uint64_t end, const bool hasCreationOrder,
+                                     std::vector<Message>& messages,
+                                     std::vector< std::pair<uint64_t, uint64_t> >& continuations) const {
+  at_(pos, end-pos);
+  const uint64_t headerSize = hasCreationOrder ? 6 : 4;
+  while ( pos+headerSize <= end ) {
+    Message msg;
+    msg.type = *at_(pos, 1);
+    msg.size = readUint_(pos+1, 2);
+    msg.flags = *at_(pos+3, 1);
+    msg.pos = pos+headerSize;
+    if ( msg.pos+msg.size > end ) throw std::runtime_error{"object header message size"};
+    if ( msg.type == MSG_CONTINUATION ) {
+      continuations.emplace_back(readAddress_(msg.pos), readLength_(msg.pos+offsetSize_));
+    }
+    else if ( msg.type != MSG_NIL ) {
+      messages.push_back(msg);
+    }
+    pos = msg.pos+msg.size;
+  }
+}
+
+// the same pre-order depth-first walk as H5Ovisit, each object is visited once
+void H5NativeReader::visitObject_(const uint64_t address, const uint32_t parent, const std::string& name,
+                                  std::vector<h5NativeObject>& objects) {
+  if ( !visited_.insert(address).second ) return;
+  std::vector<Message> messages;
+  readObjectHeader_(address, messages);
+
+  const Message* stab = nullptr;
+  const Message* linkInfo = nullptr;
+  bool hasDatatype = false, hasDataspace = false;
+  for (const auto& msg : messages) {
+    switch ( msg.type ) {
+      case MSG_SYMBOL_TABLE : stab = &msg; break;
+      case MSG_LINK_INFO : linkInfo = &msg; break;
+      case MSG_DATATYPE : hasDatatype = true; break;
+      case MSG_DATASPACE : hasDataspace = true; break;
+      case MSG_ATTRIBUTE_INFO :
+        {
+        const unsigned flags = *at_(msg.pos+1, 1);
+        const uint64_t heap = readAddress_(msg.pos+2+((flags & 0x01) ? 2 : 0));
+        if ( !isUndefined_(heap) ) throw std::runtime_error{"dense attribute storage"};
+        }
+        break;
+      default : break;
+    }
+  }
+  const bool isGroup = stab || linkInfo;
+  if ( !isGroup && !(hasDatatype && hasDataspace) ) {
+    if ( hasDatatype ) return;      // a named datatype, H5Layout doesn`t keep them
+    throw std::runtime_error{"unknown object type"};
+  }
+
+  const uint32_t index = static_cast<uint32_t>(objects.size());
+  objects.emplace_back();
+  objects.back().parent = parent;
+  objects.back().name = name;
+  objects.back().isGroup = isGroup;
+  std::vector<h5NativeAttribute> attributes;
+  for (const auto& msg : messages) {
+    if ( msg.type != MSG_ATTRIBUTE ) continue;
+    if ( msg.flags & MSG_FLAG_SHARED ) throw std::runtime_error{"shared attribute message"};
+    attributes.emplace_back();
+    readAttribute_(msg, attributes.back());
+  }
+  std::sort(attributes.begin(), attributes.end(),
+            [](const h5NativeAttribute& a, const h5NativeAttribute& b) { return a.name < b.name; });
+  objects[index].attributes = std::move(attributes);
+
+  if ( !isGroup ) return;
+  std::vector<Link> links;
+  if ( stab ) {
+    readSymbolTable_(*stab, links);
+  }
+  else {
+    const unsigned flags = *at_(linkInfo->pos+1, 1);
+    const uint64_t heap = readAddress_(linkInfo->pos+2+((flags & 0x01) ? 8 : 0));
+    if ( !isUndefined_(heap) ) throw std::runtime_error{"dense link storage"};
+    for (const auto& msg : messages) {
+      if ( msg.type == MSG_LINK ) readLinkMessage_(msg, links);
+    }
+  }
+  std::sort(links.begin(), links.end(), [](const Link& a, const Link& b) { return a.name < b.name; });
+  for (const auto& link : links) {
+    visitObject_(link.address, index, link.name, objects);
+  }
+}
+
+void H5NativeReader::readSymbolTable_(const Message& stab, std::vector<Link>& links) const {
+  const uint64_t btree = readAddress_(stab.pos);
+  const uint64_t heap = base_+readAddress_(stab.pos+offsetSize_);
+  if ( !hasSignature_(heap, "HEAP") || *at_(heap+4, 1) != 0 ) {
+    throw std::runtime_error{"local heap"};
+  }
+  const uint64_t heapData = base_+readAddress_(heap+8+2*lengthSize_);
+  readBTreeNode_(btree, heapData, links, 0);
+}
+
+void H5NativeReader::readBTreeNode_(const uint64_t address, const uint64_t heapData, std::vector<Link>& links,
+                                    const int depth) const {
+  const uint64_t pos = base_+address;
+  if ( depth > MAX_BTREE_DEPTH || !hasSignature_(pos, "TREE") || *at_(pos+4, 1) != 0 ) {
+    throw std::runtime_error{"group B-tree"};
+  }
+  const unsigned level = *at_(pos+5, 1);
+  const unsigned entries = readUint_(pos+6, 2);
+  uint64_t p = pos+8+2*offsetSize_;      // the siblings are skipped
+  for (unsigned i=0; i<entries; ++i) {
+    p += lengthSize_;                     // the key - a heap offset
+    const uint64_t child = readAddress_(p);
+    p += offsetSize_;
+    if ( level > 0 ) {
+      readBTreeNode_(child, heapData, links, depth+1);
+      continue;
+    }
+    const uint64_t node = base_+child;
+    if ( !hasSignature_(node, "SNOD") || *at_(node+4, 1) != 1 ) {
+      throw std::runtime_error{"symbol table node"};
+    }
+    const unsigned symbols = readUint_(node+6, 2);
+    const uint64_t entrySize = 2*offsetSize_+24;
+    for (unsigned s=0; s<symbols; ++s) {
+      const uint64_t entry = node+8+s*entrySize;
+      const uint64_t nameOffset = readUint_(entry, offsetSize_);
+      const uint64_t header = readAddress_(entry+offsetSize_);
+      if ( isUndefined_(header) ) continue;    // a soft link
+      const unsigned char* name = at_(heapData+nameOffset, 1);
+      const unsigned char* nameEnd = static_cast<const unsigned char*>(
+                                       std::memchr(name, '\0', size_-(heapData+nameOffset)));
+      if ( !nameEnd ) throw std::runtime_error{"link name"};
+      links.push_back(Link{std::string(reinterpret_cast<const char*>(name), nameEnd-name), header});
+    }
+  }
+}
+
+void H5NativeReader::readLinkMessage_(const Message& msg, std::vector<Link>& links) const {
+  uint64_t p = msg.pos;
+  if ( *at_(p, 1) != 1 ) throw std::runtime_error{"link message version"};
+  const unsigned flags = *at_(p+1, 1);
+  p += 2;
+  unsigned linkType = 0;
+  if ( flags & 0x08 ) linkType = *at_(p++, 1);
+  if ( flags & 0x04 ) p += 8;     // creation order
+  if ( flags & 0x10 ) p += 1;     // character set
+  const unsigned lengthBytes = 1u << (flags & 0x03);
+  const uint64_t nameLength = readUint_(p, lengthBytes);
+  p += lengthBytes;
+  const unsigned char* name = at_(p, nameLength);
+  p += nameLength;
+  if ( linkType != 0 ) return;    // soft and external links are not visited
+  links.push_back(Link{std::string(reinterpret_cast<const char*>(name), nameLength), readAddress_(p)});
+}
+
+void H5NativeReader::readAttribute_(const Message& msg, h5NativeAttribute& attr) const {
+  const uint64_t end = msg.pos+msg.size;
+  const unsigned version = *at_(msg.pos, 1);
+  if ( version < 1 || version > 3 ) throw std::runtime_error{"attribute message version"};
+  const unsigned flags = *at_(msg.pos+1, 1);
+  if ( version > 1 && (flags & 0x03) ) throw std::runtime_error{"shared attribute datatype or dataspace"};
+  const uint64_t nameSize = readUint_(msg.pos+2, 2);
+  const uint64_t datatypeSize = readUint_(msg.pos+4, 2);
+  const uint64_t dataspaceSize = readUint_(msg.pos+6, 2);
+  uint64_t p = msg.pos + (version == 3 ? 9 : 8);
+  const unsigned char* name = at_(p, nameSize);
+  attr.name.assign(reinterpret_cast<const char*>(name),
+                   std::find(name, name+nameSize, '\0')-name);
+  p += version == 1 ? pad8(nameSize) : nameSize;
+  uint64_t elementSize = 0;
+  readDatatype_(p, datatypeSize, attr, elementSize);
+  p += version == 1 ? pad8(datatypeSize) : datatypeSize;
+  readDataspace_(p, dataspaceSize, attr.info);
+  p += version == 1 ? pad8(dataspaceSize) : dataspaceSize;
+  if ( attr.info.rank < 0 || elementSize == 0 || p > end ) {
+    throw std::runtime_error{"attribute "+attr.name+" data"};
+  }
+  // the dims come from the file, the element count is checked against the message before any multiplication
+  const uint64_t maxElements = (end-p)/elementSize;
+  uint64_t numElements = 1;
+  for (const auto d : attr.info.dims) {
+    if ( d == 0 || numElements > maxElements/d ) throw std::runtime_error{"attribute "+attr.name+" data"};
+    numElements *= d;
+  }
+  if ( attr.data ) attr.data = at_(p, numElements*elementSize);
+}
+
+// fills the info as H5Aget_type gives it - the variable-length strings have the in-memory size
+void H5NativeReader::readDatatype_(const uint64_t pos, const uint64_t size, h5NativeAttribute& attr,
+                                   uint64_t& fileSize) const {
+  const unsigned char* t = at_(pos, std::max<uint64_t>(size, 8));
+  h5AttributeInfo& info = attr.info;
+  const unsigned typeClass = t[0] & 0x0f;
+  const unsigned bits0 = t[1];
+  fileSize = readUint_(pos+4, 4);
+  info.size = fileSize;
+  attr.bigEndian = bits0 & 0x01;
+  attr.data = nullptr;
+  switch ( typeClass ) {
+    case 0 :    // fixed-point
+      {
+      const unsigned offset = readUint_(pos+8, 2);
+      info.typeClass = H5T_INTEGER;
+      info.precision = readUint_(pos+10, 2);
+      info.sign = (bits0 & 0x08) ? H5T_SGN_2 : H5T_SGN_NONE;
+      const bool standard = offset == 0 && info.precision == 8*fileSize &&
+                            (fileSize == 1 || fileSize == 2 || fileSize == 4 || fileSize == 8);
+      if ( standard ) attr.data = t;    // marks it decodable, set to the value later
+      }
+      break;
+    case 1 :    // floating-point
+      {
+      const unsigned offset = readUint_(pos+8, 2);
+      info.typeClass = H5T_FLOAT;
+      info.precision = readUint_(pos+10, 2);
+      const unsigned exponentLocation = *at_(pos+12, 1);
+      const unsigned exponentSize = *at_(pos+13, 1);
+      const unsigned mantissaLocation = *at_(pos+14, 1);
+      const unsigned mantissaSize = *at_(pos+15, 1);
+      const uint64_t bias = readUint_(pos+16, 4);
+      const bool ieee32 = fileSize == 4 && exponentLocation == 23 && exponentSize == 8 &&
+                          mantissaSize == 23 && bias == 127;
+      const bool ieee64 = fileSize == 8 && exponentLocation == 52 && exponentSize == 11 &&
+                          mantissaSize == 52 && bias == 1023;
+      const bool standard = offset == 0 && info.precision == 8*fileSize && mantissaLocation == 0 &&
+                            !(bits0 & 0x40) && (ieee32 || ieee64);
+      if ( standard ) attr.data = t;
+      }
+      break;
+    case 3 :    // fixed-length string
+      info.typeClass = H5T_STRING;
+      info.strpad = static_cast<H5T_str_t>(bits0 & 0x0f);
+      info.isVariableStr = false;
+      attr.data = t;
+      break;
+    case 9 :    // variable-length
+      if ( (bits0 & 0x0f) != 1 ) throw std::runtime_error{"variable-length sequence datatype"};
+      info.typeClass = H5T_STRING;
+      info.strpad = static_cast<H5T_str_t>((bits0 >> 4) & 0x0f);
+      info.isVariableStr = true;
+      info.size = sizeof(char*);
+      break;
+    case 4 :    // bitfield, opaque, compound, reference, enumeration - only the class and size are recorded
+    case 5 :
+    case 6 :
+    case 7 :
+    case 8 :
+    case 10 :   // array
+      info.typeClass = static_cast<H5T_class_t>(typeClass);
+      break;
+    default :
+      throw std::runtime_error{"datatype class "+std::to_string(typeClass)};
+  }
+}
+
+void H5NativeReader::readDataspace_(const uint64_t pos, const uint64_t size, h5AttributeInfo& info) const {
+  const unsigned char* s = at_(pos, std::max<uint64_t>(size, 4));
+  const unsigned version = s[0];
+  const unsigned rank = s[1];
+  uint64_t p = pos;
+  if ( version == 1 ) {
+    p += 8;
+  }
+  else if ( version == 2 ) {
+    if ( s[3] == 2 ) throw std::runtime_error{"null dataspace"};
+    p += 4;
+  }
+  else {
+    throw std::runtime_error{"dataspace version "+std::to_string(version)};
+  }
+  info.rank = rank;
+  info.dims.resize(rank);
+  for (unsigned i=0; i<rank; ++i) {
+    info.dims[i] = readLength_(p+i*lengthSize_);
+  }
+}
+
+uint64_t pad8(const uint64_t n) {
+  return (n+7) & ~UINT64_C(7);
+}
+
+uint64_t readRaw(const unsigned char* p, const unsigned bytes, const bool bigEndian) {
+  uint64_t value = 0;
+  for (unsigned i=0; i<bytes; ++i) {
+    const unsigned shift = 8*(bigEndian ? bytes-1-i : i);
+    value |= static_cast<uint64_t>(p[i]) << shift;
+  }
+  return value;
+}
+
+} // end namespace myodim
@@ -0,0 +1,90 @@
+// class_H5NativeReader.hpp
+// reader of the hdf5 metadata subset used by the ODIM-H5 files, working directly on the file image
+// Ladislav Meri, SHMU
+
+#ifndef CLASS_H5NATIVEREADER_HPP
+#define CLASS_H5NATIVEREADER_HPP
+
+#include <vector>
+#include <string>
+#include <unordered_set>
+#include <stdint.h>
+#include "class_H5Layout.hpp"
+
+namespace myodim {
+
+struct h5NativeAttribute {
+  std::string name;
+  h5AttributeInfo info;
+  const unsigned char* data{nullptr};   // the raw value in the image, nullptr if not decodable here
+  bool bigEndian{false};
+};
+
+struct h5NativeObject {                 // in the H5Ovisit order, the root group first
+  uint32_t parent{UINT32_MAX};          // index of the parent group in the objects
+  std::string name;                     // the link name in the parent group
+  bool isGroup{false};
+  std::vector<h5NativeAttribute> attributes;   // sorted by name, as H5Aiterate gives them
+};
+
+// supported: superblock v0/v1, object headers v1/v2, symbol table groups, compact link storage,
+// compact attribute messages v1-v3 with integer, float, fixed and variable-length string types;
+// anything else (dense storage, shared messages, other datatypes, ...) makes read() return false,
+// so the caller can fall back to libhdf5
+class H5NativeReader {
+  public:
+    H5NativeReader(const void* image, const size_t imageSize);
+    bool read(std::vector<h5NativeObject>& objects);
+    const std::string& unsupported() const;   // the reason of the last failed read
+
+    static bool decode(const h5NativeAttribute& attr, std::string& value);
+    static bool decode(const h5NativeAttribute& attr, std::vector<double>& values);
+    static bool decode(const h5NativeAttribute& attr, std::vector<int64_t>& values);
+
+  private:
+    struct Message {
+      unsigned type;
+      unsigned flags;
+      uint64_t pos;
+      uint64_t size;
+    };
+    struct Link {
+      std::string name;
+      uint64_t address;
+    };
+
+    const unsigned char* image_;
+    uint64_t size_;
+    unsigned offsetSize_{8};
+    unsigned lengthSize_{8};
+    uint64_t base_{0};
+    std::unordered_set<uint64_t> visited_;
+    std::string unsupported_{""};
+
+    uint64_t readUint_(const uint64_t pos, const unsigned bytes) const;
+    uint64_t readAddress_(const uint64_t pos) const;
+    uint64_t readLength_(const uint64_t pos) const;
+    const unsigned char* at_(const uint64_t pos, const uint64_t bytes) const;
+    bool isUndefined_(const uint64_t address) const;
+    bool hasSignature_(const uint64_t pos, const char* signature) const;
+    uint64_t readSuperblock_();
+    void readObjectHeader_(const uint64_t address, std::vector<Message>& messages) const;
+    void readV1Messages_(uint64_t pos, const uint64_t end, std::vector<Message>& messages,
+                         std::vector< std::pair<uint64_t, uint64_t> >& continuations) const;
+    void readV2Messages_(uint64_t pos, const uint64_t end, const bool hasCreationOrder,
+                         std::vector<Message>& messages,
+                         std::vector< std::pair<uint64_t, uint64_t> >& continuations) const;
+    void visitObject_(const uint64_t address, const uint32_t parent, const std::string& name,
+                      std::vector<h5NativeObject>& objects);
+    void readSymbolTable_(const Message& stab, std::vector<Link>& links) const;
+    void readBTreeNode_(const uint64_t address, const uint64_t heapData, std::vector<Link>& links,
+                        const int depth) const;
+    void readLinkMessage_(const Message& msg, std::vector<Link>& links) const;
+    void readAttribute_(const Message& msg, h5NativeAttribute& attr) const;
+    void readDatatype_(const uint64_t pos, const uint64_t size, h5NativeAttribute& attr, uint64_t& fileSize) const;
+    void readDataspace_(const uint64_t pos, const uint64_t size, h5AttributeInfo& info) const;
+};
+
+} // end namespace myodim
+
+#endif // CLASS_H5NATIVEREADER_HPP
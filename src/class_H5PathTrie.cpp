@@ -0,0 +1,135 @@
+// class_H5PathTrie.cpp
+// trie of the hdf5 object paths with interned path components
+// Ladislav Meri, SHMU
+
+#include "class_H5PathTrie.hpp"
+
+#include <stdexcept>
+
+namespace myodim {
+
+const uint32_t H5PathTrie::ROOT;
+const uint32_t H5PathTrie::NO_NODE;
+
+H5PathTrie::H5PathTrie() {
+  clear();
+}
+
+uint32_t H5PathTrie::insert(const std::string& path) {
+  if ( path.empty() || path[0] != '/' ) {
+    throw std::runtime_error{"ERROR - "+path+" is not an absolute hdf5 path"};
+  }
+  uint32_t node = ROOT;
+  size_t begin = 1;
+  while ( begin < path.size() ) {
+    size_t end = path.find('/', begin);
+    if ( end == std::string::npos ) end = path.size();
+    node = insertChild(node, path.substr(begin, end-begin));
+    begin = end+1;
+  }
+  return node;
+}
+
+uint32_t H5PathTrie::insertChild(const uint32_t parent, const std::string& component) {
+  auto id = componentIds_.find(component);
+  if ( id == componentIds_.end() ) {
+    id = componentIds_.emplace(component, static_cast<uint32_t>(components_.size())).first;
+    components_.push_back(&id->first);
+  }
+  auto child = children_.emplace(childKey_(parent, id->second), static_cast<uint32_t>(nodes_.size()));
+  if ( child.second ) {
+    nodes_.push_back(Node{parent, id->second});
+  }
+  return child.first->second;
+}
+
+// "/" is the root, any other path has to be /c1/c2/.../cn with non-empty components
+uint32_t H5PathTrie::find(const std::string& path) const {
+  if ( path.empty() || path[0] != '/' ) return NO_NODE;
+  uint32_t node = ROOT;
+  if ( path.size() == 1 ) return node;
+  std::string component;
+  size_t begin = 1;
+  while ( begin <= path.size() ) {
+    size_t end = path.find('/', begin);
+    if ( end == std::string::npos ) end = path.size();
+    if ( end == begin ) return NO_NODE;
+    component.assign(path, begin, end-begin);
+    const uint32_t id = componentId_(component);
+    if ( id == NO_NODE ) return NO_NODE;
+    auto child = children_.find(childKey_(node, id));
+    if ( child == children_.end() ) return NO_NODE;
+    node = child->second;
+    begin = end+1;
+  }
+  return node;
+}
+
+std::string H5PathTrie::path(const uint32_t node) const {
+  std::string pathStr;
+  path(node, pathStr);
+  return pathStr;
+}
+
+void H5PathTrie::path(const uint32_t node, std::string& pathStr) const {
+  pathStr.clear();
+  if ( node == ROOT ) {
+    pathStr = "/";
+    return;
+  }
+  size_t length = 0;
+  for (uint32_t n = node; n != ROOT; n = nodes_[n].parent) {
+    length += components_[nodes_[n].component]->size()+1;
+  }
+  pathStr.resize(length);
+  for (uint32_t n = node; n != ROOT; n = nodes_[n].parent) {
+    const std::string& c = *components_[nodes_[n].component];
+    length -= c.size();
+    pathStr.replace(length, c.size(), c);
+    pathStr[--length] = '/';
+  }
+}
+
+uint32_t H5PathTrie::parent(const uint32_t node) const {
+  return node == ROOT ? NO_NODE : nodes_[node].parent;
+}
+
+const std::string& H5PathTrie::component(const uint32_t node) const {
+  return *components_[nodes_[node].component];
+}
+
+size_t H5PathTrie::size() const {
+  return nodes_.size();
+}
+
+size_t H5PathTrie::componentCount() const {
+  return components_.size();
+}
+
+size_t H5PathTrie::memoryBytes() const {
+  size_t bytes = nodes_.capacity()*sizeof(Node) + components_.capacity()*sizeof(const std::string*);
+  for (const auto& c : componentIds_) bytes += sizeof(c) + c.first.capacity() + sizeof(void*);
+  bytes += children_.size()*(sizeof(std::pair<uint64_t, uint32_t>) + sizeof(void*));
+  bytes += (componentIds_.bucket_count() + children_.bucket_count())*sizeof(void*);
+  return bytes;
+}
+
+void H5PathTrie::clear() {
+  nodes_.clear();
+  componentIds_.clear();
+  components_.clear();
+  children_.clear();
+  components_.push_back(&componentIds_.emplace("", 0).first->first);
+  nodes_.push_back(Node{ROOT, 0});
+}
+
+uint32_t H5PathTrie::componentId_(const std::string& component) const {
+  auto id = componentIds_.find(component);
+  return id == componentIds_.end() ? NO_NODE : id->second;
+}
+
+uint64_t H5PathTrie::childKey_(const uint32_t parent, const uint32_t componentId) {
+  return (static_cast<uint64_t>(parent) << 32) | componentId;
+}
+
+} // end namespace myodim
@@ -0,0 +1,51 @@
+// class_H5PathTrie.hpp
+// trie of the hdf5 object paths with interned path components
+// Ladislav Meri, SHMU
+
+#ifndef CLASS_H5PATHTRIE_HPP
+#define CLASS_H5PATHTRIE_HPP
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <stdint.h>
+
+namespace myodim {
+
+// every path is a node pointing to its parent node and to its last component,
+// the component strings (dataset12, data3, what, how, ...) are stored only once
+class H5PathTrie {
+  public:
+    static const uint32_t ROOT = 0;       // the "/" path
+    static const uint32_t NO_NODE = UINT32_MAX;
+
+    H5PathTrie();
+
+    uint32_t insert(const std::string& path);                                 // absolute path, e.g. /dataset1/what
+    uint32_t insertChild(const uint32_t parent, const std::string& component);
+    uint32_t find(const std::string& path) const;                             // NO_NODE if not present
+    std::string path(const uint32_t node) const;
+    void path(const uint32_t node, std::string& pathStr) const;               // reuses the pathStr buffer
+    uint32_t parent(const uint32_t node) const;
+    const std::string& component(const uint32_t node) const;
+    size_t size() const;                                                      // number of nodes
+    size_t componentCount() const;
+    size_t memoryBytes() const;                                               // approximate
+    void clear();
+
+  private:
+    struct Node {
+      uint32_t parent;
+      uint32_t component;
+    };
+    std::vector<Node> nodes_;
+    std::unordered_map<std::string, uint32_t> componentIds_;
+    std::vector<const std::string*> components_;              // id -> the key in componentIds_
+    std::unordered_map<uint64_t, uint32_t> children_;         // parent node and component id -> node
+    uint32_t componentId_(const std::string& component) const;
+    static uint64_t childKey_(const uint32_t parent, const uint32_t componentId);
+};
+
+} // end namespace myodim
+
+#endif // CLASS_H5PATHTRIE_HPP
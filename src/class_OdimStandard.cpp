@@ -6,6 +6,8 @@
 #include <iostream>
 #include <cstdio>
 #include <stdexcept>
+#include <cstring>
+#include <cctype>
 #include "csv.h"
 #include "class_OdimStandard.hpp"
 
@@ -14,6 +16,11 @@ namespace myodim {
 static const int CSV_COL_NUM{6};
 static const char CSV_SEPARATOR{';'};
 
+static void compileRule(const OdimEntry& entry, OdimRule& rule);
+static bool hasWildcard(const std::string& str);
+static bool isLiteralRegex(const std::string& str, std::string& literal);
+static void splitByWildcard(const std::string& str, std::string& wildcardPart, std::string& noWildcardPart);
+
 OdimStandard::OdimStandard(const std::string& csvFilePath) {
   readFromCsv(csvFilePath);
 }
@@ -35,6 +42,7 @@ void OdimStandard::readFromCsv(const std::string& csvFilePath) {
   while(csv.read_row(node, category, type, isMandatory, possibleValues, reference)){
     entries.emplace_back(OdimEntry{node, category, type, isMandatory, possibleValues, reference});
   }
+  rules();
 }
 
 void OdimStandard::updateWithCsv(const std::string& csvFilePath) {
@@ -59,6 +67,7 @@ void OdimStandard::updateWithCsv(const std::string& csvFilePath) {
       entries.push_back(e);
     }
   }
+  rules();
 }
 
 void OdimStandard::writeToCsv(const std::string& csvFilePath) {
@@ -76,6 +85,36 @@ void OdimStandard::writeToCsv(const std::string& csvFilePath) {
   fclose(f);
 }
 
+const std::vector<OdimRule>& OdimStandard::rules() const {
+  if ( rules_.size() != entries.size() ) {
+    rules_.resize(entries.size());
+    isAutomatonBuilt_ = false;
+  }
+  for (size_t i=0; i<entries.size(); ++i) {
+    const OdimEntry& e = entries[i];
+    const OdimRule& r = rules_[i];
+    if ( !r.isCompiled || r.node != e.node || r.possibleValues != e.possibleValues || r.type != e.type ) {
+      compileRule(e, rules_[i]);
+      isAutomatonBuilt_ = false;
+    }
+  }
+  return rules_;
+}
+
+const PathAutomaton& OdimStandard::pathAutomaton() const {
+  rules();
+  if ( !isAutomatonBuilt_ ) {
+    std::vector<std::string> patterns;
+    for (const auto& rule : rules_) patterns.push_back(rule.isLiteral ? "[]" : rule.node);
+    for (const auto& rule : rules_) {
+      patterns.push_back(rule.hasParentRegex ? rule.parentPattern : "[]");   // an empty class matches nothing
+    }
+    automaton_.build(patterns);
+    isAutomatonBuilt_ = true;
+  }
+  return automaton_;
+}
+
 OdimEntry* OdimStandard::entry_(const OdimEntry& e) {
   for (auto& en : entries) {
     if ( en.category == e.category &&
@@ -85,4 +124,95 @@ OdimEntry* OdimStandard::entry_(const OdimEntry& e) {
   return nullptr;
 }
 
+void compileRule(const OdimEntry& entry, OdimRule& rule) {
+  rule = OdimRule();
+  rule.node = entry.node;
+  rule.possibleValues = entry.possibleValues;
+  rule.type = entry.type;
+  rule.nodeRegex = std::regex{entry.node};
+  rule.isLiteral = isLiteralRegex(entry.node, rule.literal);
+  if ( entry.type == OdimEntry::String && !entry.possibleValues.empty() ) {
+    try {
+      rule.valueRegex = std::regex{entry.possibleValues};
+      rule.hasValueRegex = true;
+    }
+    catch (const std::regex_error&) {
+      ;  // reported by the value check, as before, only when the value is checked
+    }
+  }
+  const bool isNumber = entry.type == OdimEntry::Real || entry.type == OdimEntry::Integer;
+  const bool isNumberArray = entry.type == OdimEntry::RealArray || entry.type == OdimEntry::RealArray2D ||
+                             entry.type == OdimEntry::IntegerArray || entry.type == OdimEntry::IntegerArray2D;
+  if ( (isNumber || isNumberArray) && !entry.possibleValues.empty() ) {
+    rule.valueExpression.compile(entry.possibleValues, isNumberArray);   // a wrong one throws when evaluated
+    rule.hasValueExpression = true;
+  }
+  rule.hasWildcard = hasWildcard(entry.node);
+  if ( rule.hasWildcard ) {
+    const auto splitPosi = entry.node.rfind('/');
+    if ( splitPosi != std::string::npos && splitPosi > 0 ) {
+      rule.parentPattern = entry.node.substr(0, splitPosi) + "/[0-z]*";
+      rule.parentRegex = std::regex{rule.parentPattern};
+      rule.hasParentRegex = true;
+    }
+    splitByWildcard(entry.node, rule.wildcardPattern, rule.wildcardRest);
+    try {
+      rule.wildcardRegex = std::regex{rule.wildcardPattern};
+      rule.hasWildcardRegex = true;
+    }
+    catch (const std::regex_error&) {
+      ;  // e.g. a wildcard in the last node component, only the correction of such entry fails
+    }
+  }
+  rule.isCompiled = true;
+}
+
+bool hasWildcard(const std::string& str) {
+  return str.find('*') != std::string::npos ||
+         str.find('[') != std::string::npos ||
+         str.find('?') != std::string::npos ;
+}
+
+// true if the regex matches only itself - without the escapes of the punctuation
+bool isLiteralRegex(const std::string& str, std::string& literal) {
+  literal.clear();
+  for (size_t i=0; i<str.size(); ++i) {
+    const char c = str[i];
+    if ( c == '\\' ) {
+      if ( i+1 >= str.size() || !std::ispunct(static_cast<unsigned char>(str[i+1])) ) return false;
+      literal += str[++i];
+    }
+    else if ( std::strchr(".[]()*+?{}|^$", c) ) {
+      return false;
+    }
+    else {
+      literal += c;
+    }
+  }
+  return true;
+}
+
+void splitByWildcard(const std::string& str, std::string& wildcardPart, std::string& noWildcardPart) {
+  if ( !hasWildcard(str) ) {
+    wildcardPart = str;
+    noWildcardPart = "";
+    return;
+  }
+
+  std::vector<size_t> tmp = {str.find_last_of("*"),
+                             str.find_last_of("["),
+                             str.find_last_of("]"),
+                             str.find_last_of("?")};
+
+  size_t lastWCPosi = 0;
+  for (int i=0; i<4; ++i) {
+    if ( tmp[i] == std::string::npos ) continue;
+    if ( tmp[i] > lastWCPosi ) lastWCPosi = tmp[i];
+  }
+  std::string wrkStr = str.substr(lastWCPosi);
+  auto p = wrkStr.find("/");
+  wildcardPart = str.substr(0,lastWCPosi+p);
+  noWildcardPart = str.substr(lastWCPosi+p);
+}
+
 } // end namespace myodim
@@ -8,10 +8,35 @@
 
 #include <vector>
 #include <string>
+#include <regex>
 #include "class_OdimEntry.hpp"
+#include "class_PathAutomaton.hpp"
+#include "class_ValueExpression.hpp"
 
 namespace myodim {
 
+struct OdimRule {   // the regexes of an entry, compiled once and reused for all the checked files
+  std::string node{""};              // what the regexes were compiled from
+  std::string possibleValues{""};
+  OdimEntry::Type type{OdimEntry::Undefined};
+  bool isCompiled{false};
+  std::regex nodeRegex;
+  bool isLiteral{false};             // a node without regex metacharacters, looked up directly in the layout
+  std::string literal{""};           // the node path with the escapes resolved
+  bool hasValueRegex{false};         // only the possible values of the String entries are regexes
+  std::regex valueRegex;
+  bool hasValueExpression{false};    // the possible values of the Real and Integer entries and their arrays
+  ValueExpression valueExpression;
+  bool hasWildcard{false};
+  bool hasParentRegex{false};        // the parent of a wildcard node with any child - the mandatory existence check
+  std::string parentPattern{""};
+  std::regex parentRegex;
+  bool hasWildcardRegex{false};
+  std::string wildcardPattern{""};   // the node up to the last wildcard - the substitution of wildcards in correct
+  std::regex wildcardRegex;
+  std::string wildcardRest{""};
+};
+
 class OdimStandard {
   public:
     std::vector<OdimEntry> entries;
@@ -20,8 +45,15 @@ class OdimStandard {
     void readFromCsv(const std::string& csvFilePath);
     void updateWithCsv(const std::string& csvFilePath);
     void writeToCsv(const std::string& csvFilePath);
+    const std::vector<OdimRule>& rules() const;   // parallel to entries, recompiled only for the changed entries
+    // all the node regexes (IDs are the entry indexes, the literal nodes match nothing there) and the parent regexes
+    // of the wildcard entries (IDs are entries.size()+entry index) in one automaton, rebuilt when the rules change
+    const PathAutomaton& pathAutomaton() const;
     
   private:
+    mutable std::vector<OdimRule> rules_;
+    mutable PathAutomaton automaton_;
+    mutable bool isAutomatonBuilt_{false};
     OdimEntry* entry_(const OdimEntry& e);
 };
 
@@ -0,0 +1,290 @@
+// class_PathAutomaton.cpp
+// class to match a path against many node regexes in one pass - a lazily built DFA
+// Ladislav Meri, SHMU
+
+#include "class_PathAutomaton.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace myodim {
+
+static const size_t MAX_DFA_STATES = 4096;   // the built DFA is dropped and built again from the next path above it
+
+PathAutomaton::PathAutomaton(const std::vector<std::string>& patterns) {
+  build(patterns);
+}
+
+void PathAutomaton::build(const std::vector<std::string>& patterns) {
+  nfa_.clear();
+  starts_.clear();
+  fallbacks_.clear();
+  isFallback_.assign(patterns.size(), false);
+  for (size_t i=0; i<patterns.size(); ++i) {
+    if ( !parse_(patterns[i], i) ) {
+      fallbacks_.emplace_back(i, std::regex{patterns[i]});
+      isFallback_[i] = true;
+    }
+  }
+  resetDfa_();
+}
+
+size_t PathAutomaton::size() const {
+  return isFallback_.size();
+}
+
+bool PathAutomaton::isFallback(const uint32_t id) const {
+  return isFallback_.at(id);
+}
+
+void PathAutomaton::match(const std::string& path, std::vector<uint32_t>& ids) const {
+  ids.clear();
+  if ( dfaSets_.empty() ) resetDfa_();
+  int state = 0;
+  for (const char c : path) {
+    state = step_(state, static_cast<unsigned char>(c));
+    if ( state == DEAD ) break;
+  }
+  if ( state != DEAD ) ids = dfaAccepts_[state];
+  if ( fallbacks_.empty() ) return;
+  for (const auto& fallback : fallbacks_) {
+    if ( std::regex_match(path, fallback.second) ) ids.push_back(fallback.first);
+  }
+  std::sort(ids.begin(), ids.end());
+}
+
+size_t PathAutomaton::dfaStateCount() const {
+  return dfaSets_.size();
+}
+
+int PathAutomaton::addState_() {
+  nfa_.emplace_back();
+  return nfa_.size()-1;
+}
+
+bool PathAutomaton::parse_(const std::string& pattern, const uint32_t id) {
+  const size_t nfaSize = nfa_.size();
+  size_t pos = 0;
+  Fragment frag;
+  if ( !parseAlternation_(pattern, pos, frag) || pos != pattern.size() ) {
+    nfa_.resize(nfaSize);    // the unfinished states are dropped
+    return false;
+  }
+  const int accept = addState_();
+  nfa_[accept].accept = id;
+  nfa_[frag.end].eps1 = accept;
+  starts_.push_back(frag.start);
+  return true;
+}
+
+bool PathAutomaton::parseAlternation_(const std::string& p, size_t& pos, Fragment& frag) {
+  if ( !parseConcatenation_(p, pos, frag) ) return false;
+  while ( pos < p.size() && p[pos] == '|' ) {
+    ++pos;
+    Fragment other;
+    if ( !parseConcatenation_(p, pos, other) ) return false;
+    const int start = addState_();
+    const int end = addState_();
+    nfa_[start].eps1 = frag.start;
+    nfa_[start].eps2 = other.start;
+    nfa_[frag.end].eps1 = end;
+    nfa_[other.end].eps1 = end;
+    frag = Fragment{start, end};
+  }
+  return true;
+}
+
+bool PathAutomaton::parseConcatenation_(const std::string& p, size_t& pos, Fragment& frag) {
+  frag = emptyFragment_();
+  while ( pos < p.size() && p[pos] != '|' && p[pos] != ')' ) {
+    Fragment atom;
+    if ( !parseAtom_(p, pos, atom) ) return false;
+    nfa_[frag.end].eps1 = atom.start;
+    frag.end = atom.end;
+  }
+  return true;
+}
+
+// an atom with its optional quantifier
+bool PathAutomaton::parseAtom_(const std::string& p, size_t& pos, Fragment& frag) {
+  const char c = p[pos];
+  CharSet chars;
+  switch ( c ) {
+    case '(' :
+      ++pos;
+      if ( pos < p.size() && p[pos] == '?' ) {
+        if ( pos+1 >= p.size() || p[pos+1] != ':' ) return false;    // lookaheads
+        pos += 2;
+      }
+      if ( !parseAlternation_(p, pos, frag) || pos >= p.size() || p[pos] != ')' ) return false;
+      ++pos;
+      break;
+    case '[' :
+      if ( !parseBracket_(p, pos, chars) ) return false;
+      frag = charFragment_(chars);
+      break;
+    case '.' :
+      chars.set();
+      chars.reset('\n');
+      chars.reset('\r');
+      frag = charFragment_(chars);
+      ++pos;
+      break;
+    case '\\' :
+      if ( pos+1 >= p.size() || !std::ispunct(static_cast<unsigned char>(p[pos+1])) ) return false;   // \d, \b, \1, ...
+      chars.set(static_cast<unsigned char>(p[pos+1]));
+      frag = charFragment_(chars);
+      pos += 2;
+      break;
+    case '*' : case '+' : case '?' : case '{' : case '}' : case ']' : case '^' : case '$' :
+      return false;
+    default :
+      chars.set(static_cast<unsigned char>(c));
+      frag = charFragment_(chars);
+      ++pos;
+      break;
+  }
+
+  if ( pos >= p.size() ) return true;
+  const char q = p[pos];
+  if ( q != '*' && q != '+' && q != '?' ) return p[pos] != '{';
+  ++pos;
+  if ( pos < p.size() && p[pos] == '?' ) ++pos;     // a lazy quantifier matches the same paths
+  const int start = addState_();
+  const int end = addState_();
+  switch ( q ) {
+    case '*' :
+      nfa_[start].eps1 = frag.start;
+      nfa_[start].eps2 = end;
+      nfa_[frag.end].eps1 = frag.start;
+      nfa_[frag.end].eps2 = end;
+      break;
+    case '+' :
+      nfa_[start].eps1 = frag.start;
+      nfa_[frag.end].eps1 = frag.start;
+      nfa_[frag.end].eps2 = end;
+      break;
+    default :   // '?'
+      nfa_[start].eps1 = frag.start;
+      nfa_[start].eps2 = end;
+      nfa_[frag.end].eps1 = end;
+      break;
+  }
+  frag = Fragment{start, end};
+  if ( pos >= p.size() ) return true;
+  return p[pos] != '*' && p[pos] != '+' && p[pos] != '?' && p[pos] != '{';
+}
+
+bool PathAutomaton::parseBracket_(const std::string& p, size_t& pos, CharSet& chars) {
+  ++pos;
+  bool negate = false;
+  if ( pos < p.size() && p[pos] == '^' ) {
+    negate = true;
+    ++pos;
+  }
+  while ( pos < p.size() && p[pos] != ']' ) {
+    const unsigned char first = p[pos];
+    if ( first == '\\' || (first == '[' && pos+1 < p.size() && (p[pos+1] == ':' || p[pos+1] == '.' || p[pos+1] == '=')) ) return false;
+    if ( pos+2 < p.size() && p[pos+1] == '-' && p[pos+2] != ']' ) {
+      const unsigned char last = p[pos+2];
+      if ( last == '\\' || last == '[' || last < first ) return false;
+      for (unsigned ch=first; ch<=last; ++ch) chars.set(ch);
+      pos += 3;
+    }
+    else {
+      chars.set(first);
+      ++pos;
+    }
+  }
+  if ( pos >= p.size() ) return false;
+  ++pos;
+  if ( negate ) chars.flip();
+  return true;
+}
+
+PathAutomaton::Fragment PathAutomaton::charFragment_(const CharSet& chars) {
+  const int start = addState_();
+  const int end = addState_();
+  nfa_[start].chars = chars;
+  nfa_[start].next = end;
+  return Fragment{start, end};
+}
+
+PathAutomaton::Fragment PathAutomaton::emptyFragment_() {
+  const int state = addState_();
+  return Fragment{state, state};
+}
+
+void PathAutomaton::closure_(std::vector<int>& states) const {
+  std::vector<bool> isIn(nfa_.size(), false);
+  std::vector<int> stack;
+  for (const int s : states) {
+    if ( !isIn[s] ) {
+      isIn[s] = true;
+      stack.push_back(s);
+    }
+  }
+  while ( !stack.empty() ) {
+    const NfaState& state = nfa_[stack.back()];
+    stack.pop_back();
+    for (const int next : {state.eps1, state.eps2}) {
+      if ( next >= 0 && !isIn[next] ) {
+        isIn[next] = true;
+        stack.push_back(next);
+      }
+    }
+  }
+  states.clear();
+  for (size_t i=0; i<isIn.size(); ++i) {
+    if ( isIn[i] ) states.push_back(i);
+  }
+}
+
+int PathAutomaton::dfaState_(std::vector<int>& states) const {
+  const auto found = dfaIndex_.find(states);
+  if ( found != dfaIndex_.end() ) return found->second;
+  const int index = dfaSets_.size();
+  std::vector<uint32_t> accepts;
+  for (const int s : states) {
+    if ( nfa_[s].accept >= 0 ) accepts.push_back(nfa_[s].accept);
+  }
+  std::sort(accepts.begin(), accepts.end());
+  dfaIndex_.emplace(states, index);
+  dfaSets_.push_back(std::move(states));
+  dfaTransitions_.resize(dfaTransitions_.size()+256, UNKNOWN);
+  dfaAccepts_.push_back(std::move(accepts));
+  return index;
+}
+
+int PathAutomaton::step_(const int dfaState, const unsigned char c) const {
+  const int known = dfaTransitions_[dfaState*256+c];
+  if ( known != UNKNOWN ) return known;
+  std::vector<int> next;
+  for (const int s : dfaSets_[dfaState]) {
+    if ( nfa_[s].next >= 0 && nfa_[s].chars.test(c) ) next.push_back(nfa_[s].next);
+  }
+  if ( next.empty() ) {
+    dfaTransitions_[dfaState*256+c] = DEAD;
+    return DEAD;
+  }
+  closure_(next);
+  if ( dfaSets_.size() >= MAX_DFA_STATES ) {
+    resetDfa_();     // the current state is gone, the transition is not remembered
+    return dfaState_(next);
+  }
+  const int nextState = dfaState_(next);
+  dfaTransitions_[dfaState*256+c] = nextState;
+  return nextState;
+}
+
+void PathAutomaton::resetDfa_() const {
+  dfaIndex_.clear();
+  dfaSets_.clear();
+  dfaTransitions_.clear();
+  dfaAccepts_.clear();
+  std::vector<int> start = starts_;
+  closure_(start);
+  dfaState_(start);
+}
+
+} // end namespace myodim
@@ -0,0 +1,72 @@
+// class_PathAutomaton.hpp
+// class to match a path against many node regexes in one pass - a lazily built DFA
+// Ladislav Meri, SHMU
+
+#ifndef CLASS_PATHAUTOMATON_HPP
+#define CLASS_PATHAUTOMATON_HPP
+
+#include <vector>
+#include <string>
+#include <bitset>
+#include <map>
+#include <regex>
+#include <stdint.h>
+
+namespace myodim {
+
+// supported regex subset (the one of the standard-definition tables): literals, escaped punctuation, '.',
+// bracket expressions with ranges and negation, groups, '|' and the '*', '+', '?' quantifiers;
+// the patterns using anything else are matched by std::regex, each separately
+class PathAutomaton {
+  public:
+    PathAutomaton() = default;
+    explicit PathAutomaton(const std::vector<std::string>& patterns);
+    void build(const std::vector<std::string>& patterns);   // the pattern IDs are the indexes
+    size_t size() const;
+    bool isFallback(const uint32_t id) const;      // matched by std::regex, not by the automaton
+    void match(const std::string& path, std::vector<uint32_t>& ids) const;   // IDs of all the fully matching patterns, ascending
+    size_t dfaStateCount() const;
+
+  private:
+    typedef std::bitset<256> CharSet;
+    struct NfaState {
+      CharSet chars;       // the consuming transition to next, none for the epsilon states
+      int next{-1};
+      int eps1{-1};
+      int eps2{-1};
+      int accept{-1};      // pattern ID
+    };
+    struct Fragment {
+      int start;
+      int end;             // an epsilon state without transitions yet
+    };
+
+    std::vector<NfaState> nfa_;
+    std::vector<int> starts_;
+    std::vector<std::pair<uint32_t, std::regex>> fallbacks_;
+    std::vector<bool> isFallback_;
+
+    // the lazily built DFA - its states are the epsilon closures of NFA state sets
+    enum { UNKNOWN = -2, DEAD = -1 };    // the special DFA transitions
+    mutable std::map<std::vector<int>, int> dfaIndex_;
+    mutable std::vector<std::vector<int>> dfaSets_;
+    mutable std::vector<int> dfaTransitions_;          // 256 per DFA state
+    mutable std::vector<std::vector<uint32_t>> dfaAccepts_;
+
+    int addState_();
+    bool parse_(const std::string& pattern, const uint32_t id);
+    bool parseAlternation_(const std::string& p, size_t& pos, Fragment& frag);
+    bool parseConcatenation_(const std::string& p, size_t& pos, Fragment& frag);
+    bool parseAtom_(const std::string& p, size_t& pos, Fragment& frag);
+    bool parseBracket_(const std::string& p, size_t& pos, CharSet& chars);
+    Fragment charFragment_(const CharSet& chars);
+    Fragment emptyFragment_();
+    void closure_(std::vector<int>& states) const;
+    int dfaState_(std::vector<int>& states) const;
+    int step_(const int dfaState, const unsigned char c) const;
+    void resetDfa_() const;
+};
+
+} // end namespace myodim
+
+#endif // CLASS_PATHAUTOMATON_HPP
@@ -0,0 +1,240 @@
+// class_ValueExpression.cpp
+// class to hold the PossibleValues expression of a numeric entry - parsed once, evaluated for every attribute
+// Ladislav Meri, SHMU
+
+#include "class_ValueExpression.hpp"
+#include "module_Statistics.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+namespace myodim {
+
+static const double MAX_DOUBLE_DIFF = 0.0001;
+
+static bool hasIntervalSigns(const std::string& str);
+static void splitComparisons(const std::string& str, std::vector<std::string>& comparisons,
+                             std::vector<ValueExpression::Operator>& operators);
+static void parseTerm(std::string comparison, const bool isArray, ValueExpression::Term& term);
+static ValueExpression::Statistic eraseStatistic(std::string& comparison);
+static bool isTrue(const ValueExpression::Term& term, const double value);
+
+ValueExpression::ValueExpression(const std::string& str, const bool isArray) {
+  compile(str, isArray);
+}
+
+// the errors are kept and thrown by evaluate(), so a wrong string fails only when some value is checked
+void ValueExpression::compile(const std::string& str, const bool isArray) {
+  source_ = str;
+  isInterval_ = hasIntervalSigns(str);
+  terms_.clear();
+  operators_.clear();
+  error_ = nullptr;
+  neededStatistics_ = 0;
+  try {
+    if ( !isInterval_ ) {
+      if ( isArray ) {
+        throw std::runtime_error("ERROR - wrong assumed value string \"" + str + "\" - " +
+                                 "assumed value string for array attributes should use "+
+                                 "logical operators and statistics (e.g. min<=1.000 or mean==5.0 or first>1.0&&last<10.0 ...)");
+      }
+      Term term;
+      term.number = std::stod(str);
+      terms_.push_back(term);
+      return;
+    }
+    std::vector<std::string> comparisons;
+    splitComparisons(str, comparisons, operators_);
+    for (const auto& comparison : comparisons) {
+      terms_.emplace_back();
+      parseTerm(comparison, isArray, terms_.back());
+      switch ( terms_.back().statistic ) {
+        case Min : neededStatistics_ |= NEED_MIN; break;
+        case Max : neededStatistics_ |= NEED_MAX; break;
+        case Mean : neededStatistics_ |= NEED_MEAN; break;
+        default : break;
+      }
+    }
+  }
+  catch (...) {
+    error_ = std::current_exception();
+  }
+}
+
+const std::string& ValueExpression::source() const {
+  return source_;
+}
+
+bool ValueExpression::isInterval() const {
+  return isInterval_;
+}
+
+bool ValueExpression::isValid() const {
+  return !error_;
+}
+
+void ValueExpression::rethrowError() const {
+  if ( error_ ) std::rethrow_exception(error_);
+}
+
+const std::vector<ValueExpression::Term>& ValueExpression::terms() const {
+  return terms_;
+}
+
+const std::vector<ValueExpression::Operator>& ValueExpression::operators() const {
+  return operators_;
+}
+
+bool ValueExpression::evaluate(const double value) const {
+  rethrowError();
+  const double statistics[] = {value, value, value, value, value, value};
+  return evaluate_(statistics);
+}
+
+bool ValueExpression::evaluate(const std::vector<double>& values) const {
+  return evaluateArray_(values);
+}
+
+bool ValueExpression::evaluate(const std::vector<int64_t>& values) const {
+  return evaluateArray_(values);
+}
+
+template <typename T>
+bool ValueExpression::evaluateArray_(const std::vector<T>& values) const {
+  rethrowError();
+  ArrayStatistics<T> arrayStats;
+  arrayStatistics(values.data(), values.size(), neededStatistics_, arrayStats);
+  double statistics[6];
+  statistics[Value] = arrayStats.first;
+  statistics[First] = arrayStats.first;
+  statistics[Last] = arrayStats.last;
+  statistics[Min] = arrayStats.min;
+  statistics[Max] = arrayStats.max;
+  statistics[Mean] = arrayStats.mean;
+  return evaluate_(statistics);
+}
+
+bool ValueExpression::evaluate_(const double* statistics) const {
+  bool result = isTrue(terms_[0], statistics[terms_[0].statistic]);
+  for (size_t i=0; i<operators_.size(); ++i) {
+    const Term& term = terms_[i+1];
+    if ( operators_[i] == And ) {
+      result = result && isTrue(term, statistics[term.statistic]);
+    }
+    else {
+      result = result || isTrue(term, statistics[term.statistic]);
+    }
+  }
+  return result;
+}
+
+bool hasIntervalSigns(const std::string& str) {
+  return str.find('=') != std::string::npos ||
+         str.find('<') != std::string::npos ||
+         str.find('>') != std::string::npos ||
+         str.find("+-") != std::string::npos;
+}
+
+void splitComparisons(const std::string& str, std::vector<std::string>& comparisons,
+                      std::vector<ValueExpression::Operator>& operators) {
+  std::string rest = str;
+  size_t pos;
+  while ((pos = std::min(rest.find("&&"), rest.find("||"))) != std::string::npos) {
+    const std::string comparison = rest.substr(0, pos);
+    if ( hasIntervalSigns(comparison) ) {
+      comparisons.push_back(comparison);
+    }
+    operators.push_back(rest[pos] == '&' ? ValueExpression::And : ValueExpression::Or);
+    rest.erase(0, pos + 2);
+  }
+  if ( hasIntervalSigns(rest) ) {
+    comparisons.push_back(rest);
+  }
+  if ( comparisons.size() != operators.size()+1 ) {
+    throw std::runtime_error("ERROR - assumed value string \"" + str +
+                             "\" not parsed correctly.");
+  }
+}
+
+// the digits and the characters up to '.' (the signs +-,. and the space) are the number, the rest is the sign
+void parseTerm(std::string comparison, const bool isArray, ValueExpression::Term& term) {
+  if ( isArray ) term.statistic = eraseStatistic(comparison);
+  std::string signStr, numberStr;
+  bool hasPlusMinus = false;
+  for (size_t i=0; i<comparison.length(); ++i) {
+    if ( (comparison[i] >= '0' && comparison[i] <= '9') || comparison[i] <= '.' ) {
+      numberStr.append(1, comparison[i]);
+      if ( comparison[i] == '-' && i > 0 && comparison[i-1] == '+') {
+        hasPlusMinus = true;
+      }
+    }
+    else {
+      signStr.append(1, comparison[i]);
+    }
+  }
+
+  if ( hasPlusMinus ) {
+    const size_t pos = numberStr.find("+-");
+    term.comparison = ValueExpression::Within;
+    term.number = std::stod(numberStr.substr(0, pos));
+    term.tolerance = std::stod(numberStr.substr(pos + 2));
+    return;
+  }
+
+  term.number = numberStr.empty() ? std::nan("") : std::stod(numberStr);
+  if ( signStr == "=" || signStr == "==" ) {
+    term.comparison = ValueExpression::Equal;
+  }
+  else if ( signStr == "<=" ) {
+    term.comparison = ValueExpression::LessEqual;
+  }
+  else if ( signStr == "<" ) {
+    term.comparison = ValueExpression::Less;
+  }
+  else if ( signStr == ">=" ) {
+    term.comparison = ValueExpression::GreaterEqual;
+  }
+  else if ( signStr == ">" ) {
+    term.comparison = ValueExpression::Greater;
+  }
+  else {
+    throw std::runtime_error("ERROR - unknown sign in the "+
+                             comparison+" PossibleValues string");
+  }
+}
+
+ValueExpression::Statistic eraseStatistic(std::string& comparison) {
+  static const std::pair<const char*, ValueExpression::Statistic> keywords[] = {
+    {"first", ValueExpression::First}, {"last", ValueExpression::Last}, {"min", ValueExpression::Min},
+    {"max", ValueExpression::Max}, {"mean", ValueExpression::Mean}
+  };
+  for (const auto& keyword : keywords) {
+    const size_t pos = comparison.find(keyword.first);
+    if ( pos != std::string::npos ) {
+      comparison.erase(pos, std::char_traits<char>::length(keyword.first));
+      return keyword.second;
+    }
+  }
+  throw std::runtime_error("ERROR - proper statistics not found in the \"" +
+                           comparison + "\" comparison");
+}
+
+bool isTrue(const ValueExpression::Term& term, const double value) {
+  switch ( term.comparison ) {
+    case ValueExpression::Equal :
+      return std::fabs(value - term.number) < MAX_DOUBLE_DIFF;
+    case ValueExpression::Less :
+      return value < term.number;
+    case ValueExpression::LessEqual :
+      return value <= term.number;
+    case ValueExpression::Greater :
+      return value > term.number;
+    case ValueExpression::GreaterEqual :
+      return value >= term.number;
+    default :   // Within
+      return value >= term.number-term.tolerance && value <= term.number+term.tolerance;
+  }
+}
+
+} // end namespace myodim
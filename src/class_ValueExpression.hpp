@@ -0,0 +1,58 @@
+// class_ValueExpression.hpp
+// class to hold the PossibleValues expression of a numeric entry - parsed once, evaluated for every attribute
+// Ladislav Meri, SHMU
+
+#ifndef CLASS_VALUEEXPRESSION_HPP
+#define CLASS_VALUEEXPRESSION_HPP
+
+#include <vector>
+#include <string>
+#include <exception>
+#include <stdint.h>
+
+namespace myodim {
+
+// a plain number (e.g. 5.0) or comparisons joined by && and || (e.g. >=0&&<360, 1.0+-0.1, min>0&&max<=10),
+// the statistics are used by the array attributes only; the operators are applied from left to right
+// without precedence, as the PossibleValues strings were always evaluated
+class ValueExpression {
+  public:
+    enum Statistic { Value, First, Last, Min, Max, Mean };
+    enum Comparison { Equal, Less, LessEqual, Greater, GreaterEqual, Within };   // Within - the +- tolerance
+    enum Operator { And, Or };
+    struct Term {
+      Statistic statistic{Value};
+      Comparison comparison{Equal};
+      double number{0.0};          // the center for Within
+      double tolerance{0.0};
+    };
+
+    ValueExpression() = default;
+    explicit ValueExpression(const std::string& str, const bool isArray=false);
+    void compile(const std::string& str, const bool isArray=false);
+    const std::string& source() const;
+    bool isInterval() const;                          // comparisons, not a plain number
+    bool isValid() const;
+    void rethrowError() const;                        // the parsing error, if any
+    const std::vector<Term>& terms() const;
+    const std::vector<Operator>& operators() const;
+    bool evaluate(const double value) const;          // throws the parsing error
+    bool evaluate(const std::vector<double>& values) const;
+    bool evaluate(const std::vector<int64_t>& values) const;   // without a conversion to double
+
+  private:
+    std::string source_{""};
+    bool isInterval_{false};
+    std::vector<Term> terms_;
+    std::vector<Operator> operators_;
+    std::exception_ptr error_;
+    unsigned neededStatistics_{0};                    // only these are computed for the arrays
+
+    bool evaluate_(const double* statistics) const;   // indexed by Statistic
+    template <typename T>
+    bool evaluateArray_(const std::vector<T>& values) const;
+};
+
+} // end namespace myodim
+
+#endif // CLASS_VALUEEXPRESSION_HPP
@@ -10,51 +10,60 @@
 #include <iostream>
 #include <cmath> //fabs
 #include <algorithm> // std::any_of
-#include <limits> //std::numeric_limits<int>::max()
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <exception>
 #include "module_Compare.hpp"
 
 namespace myodim {
 
 bool printInfo{true};
-static const double MAX_DOUBLE_DIFF = 0.0001;
-static const std::string WMO_REGEX = ".*(WMO:[0-9]{5})|(WMO:[0-9]{7}).*";
-static const std::string NOD_REGEX = ".*NOD:[\\x00-\\x7F]*.*";  //only ASCII
-static const std::string RAD_REGEX = ".*RAD:.*";
-static const std::string PLC_REGEX = ".*PLC:.*";
-static const std::string ORG_REGEX = ".*ORG:.[0-9]*.*";
-static const std::string CTY_REGEX = ".*CTY:.[0-9]*.*";
-static const std::string CMT_REGEX = ".*CMT:.*";
-static const std::string WIGOS_REGEX = ".*WIGOS:[0-9]*-[0-9]*-[0-9]*-[\\x00-\\x7F]*.*";
-
+unsigned compareWorkers{1};
 
 static const std::string csvDirPathEnv{"ODIMH5_VALIDATOR_CSV_DIR"};
+static const size_t MIN_ENTRIES_PER_WORKER = 32;   // a thread is started only for at least as many entries
+
+struct MatchMatrix {   // pattern ID of OdimStandard::pathAutomaton() -> indexes of the matching layout objects
+  std::vector< std::vector<uint32_t> > groups;
+  std::vector< std::vector<uint32_t> > datasets;
+  std::vector< std::vector<uint32_t> > attributes;
+};
+
+struct EntryResult {   // the output of the check of one entry, printed after all the entries are checked
+  bool isCompliant{true};
+  std::ostringstream out;
+  OdimStandard failed;
+  std::exception_ptr error;
+};
+
+static size_t workerCount();
+static void matchLayout(const myodim::H5Layout& h5layout, const OdimStandard& odimStandard, MatchMatrix& matches);
 static bool checkCompliance(myodim::H5Layout& h5layout, const OdimStandard& odimStandard,
-                            const bool checkOptional, OdimStandard* failedEntries=nullptr);
-static bool checkExtraFeatures(const myodim::H5Layout& h5layout, const OdimStandard& odimStandard);
+                            const MatchMatrix& matches, const bool checkOptional,
+                            OdimStandard* failedEntries=nullptr);
+static bool checkEntry(const myodim::H5Layout& h5layout, const OdimEntry& entry, const OdimRule& rule,
+                       const MatchMatrix& matches, const size_t iEntry, std::ostream& out,
+                       OdimStandard* failedEntries);
+static bool checkExtraFeatures(myodim::H5Layout& h5layout, const OdimStandard& odimStandard,
+                               const MatchMatrix& matches);
 static bool checkMandatoryExistenceInAll(myodim::H5Layout& h5layout, const OdimStandard& odimStandard,
-                                        OdimStandard* failedEntries=nullptr);
-static void splitNodePath(const std::string& node, std::string& parent, std::string& child);
-static void addIfUnique(std::vector<std::string>& list, const std::string& str);
-static bool hasIntervalSigns(const std::string& assumedValueStr);
-static bool checkValueInterval(const double attrValue, const std::string& assumedValueStr);
+                                        const MatchMatrix& matches, OdimStandard* failedEntries=nullptr);
 static bool checkWhatSourceParts(const std::string& whatSource, std::string& errorMessage);
-static std::vector<std::string> splitString(std::string str, const std::string& delimiter);
-static void printWrongTypeMessage(const OdimEntry& entry, const h5Entry& attr, const std::string errmsg="");
-static void printIncorrectValueMessage(const OdimEntry& entry, const h5Entry& attr,
+static bool parseWhatSourceId(const std::string& whatSource, size_t begin, const size_t end,
+                              WhatSource& parsed, std::string& errorMessage);
+static bool isAnyId(const std::string& value);
+static bool isAsciiId(const std::string& value);
+static bool isNumberId(const std::string& value);
+static bool isWmoId(const std::string& value);
+static bool isWigosId(const std::string& value);
+static void printWrongTypeMessage(std::ostream& out, const OdimEntry& entry, const h5Entry& attr,
+                                  const std::string errmsg="");
+static void printIncorrectValueMessage(std::ostream& out, const OdimEntry& entry, const h5Entry& attr,
                                        const std::string& failedValueMessage);
-static void printWrongImageAttributes(const OdimEntry& entry);
-static void parseAssumedValueStr(const std::string& assumedValueStr,
-                                 std::vector<std::string>& comparisons,
-                                 std::vector<std::string>& operators);
-static void getArrayStatistics(const std::vector<double>& values, double& first, double& last,
-                               double& min, double& max, double& mean);
-static double valueFromStatistics(std::string& comparison,
-                                  double first, double last, double min, double max, double mean);
-static void splitPlusMinus(std::string pmString, double& center, double& interval);
-static bool entryFoundInDocTree(const std::vector<std::string>& parentsFound,
-                                const std::vector<std::string>& entriesFound);
-static bool allBaseParentsFoundInEntries(const std::vector<std::string>& baseParents,
-                                        const std::vector<std::string>& entriesFound);
+static void printWrongImageAttributes(std::ostream& out, const OdimEntry& entry);
+static bool entryFoundInDocTree(const H5PathTrie& paths, const std::vector<uint32_t>& parents,
+                                const std::vector<bool>& hasEntry);
 
 std::string getCsvFileNameFrom(const myodim::H5Layout& h5layout) {
   std::string csvFileName;
@@ -118,206 +127,217 @@ bool compare(myodim::H5Layout& h5layout, const OdimStandard& odimStandard,
              const bool checkOptional, const bool checkExtras,
              OdimStandard* failedEntries) {
   
-  bool isCompliant = checkCompliance(h5layout, odimStandard, checkOptional, failedEntries) ;
+  MatchMatrix matches;
+  matchLayout(h5layout, odimStandard, matches);
+
+  bool isCompliant = checkCompliance(h5layout, odimStandard, matches, checkOptional, failedEntries) ;
   //std::cout << "DBG - isCompliant = " << isCompliant << std::endl;
-  bool mandatoryExistsInAll = checkMandatoryExistenceInAll(h5layout, odimStandard, failedEntries);
+  bool mandatoryExistsInAll = checkMandatoryExistenceInAll(h5layout, odimStandard, matches, failedEntries);
   //std::cout << "DBG - mandatoryExistsInAll = " << mandatoryExistsInAll << std::endl;
   isCompliant = isCompliant && mandatoryExistsInAll;
 
-  if ( checkExtras ) checkExtraFeatures(h5layout, odimStandard);
+  if ( checkExtras ) checkExtraFeatures(h5layout, odimStandard, matches);
   
   return isCompliant;
 }
 
+size_t workerCount() {
+  return compareWorkers > 0 ? compareWorkers : 1;
+}
+
+// every layout path goes through the automaton of all the node regexes once
+void matchLayout(const myodim::H5Layout& h5layout, const OdimStandard& odimStandard, MatchMatrix& matches) {
+  const PathAutomaton& automaton = odimStandard.pathAutomaton();
+  std::vector<uint32_t> ids;
+  const auto fill = [&](const std::vector<h5Entry>& objects, std::vector< std::vector<uint32_t> >& matrix) {
+    matrix.assign(automaton.size(), std::vector<uint32_t>());
+    for (size_t k=0; k<objects.size(); ++k) {
+      automaton.match(objects[k].name(), ids);
+      for (const uint32_t id : ids) matrix[id].push_back(k);
+    }
+  };
+  fill(h5layout.groups, matches.groups);
+  fill(h5layout.datasets, matches.datasets);
+  fill(h5layout.attributes, matches.attributes);
+
+  // the literal nodes are not in the automaton, they are looked up in the layout index
+  const std::vector<OdimRule>& rules = odimStandard.rules();
+  for (size_t i=0; i<rules.size(); ++i) {
+    if ( !rules[i].isLiteral ) continue;
+    size_t k = h5layout.findGroup(rules[i].literal);
+    if ( k != H5Layout::NOT_FOUND ) matches.groups[i].push_back(k);
+    k = h5layout.findDataset(rules[i].literal);
+    if ( k != H5Layout::NOT_FOUND ) matches.datasets[i].push_back(k);
+    k = h5layout.findAttribute(rules[i].literal);
+    if ( k != H5Layout::NOT_FOUND ) matches.attributes[i].push_back(k);
+  }
+}
+
+// the entries are checked by up to compareWorkers threads started for this call - one per MIN_ENTRIES_PER_WORKER
+// entries, a short table is checked in the calling thread; each entry writes into its own buffer and the buffers
+// are printed in the order of the entries, so the output is the same as of a serial run
 bool checkCompliance(myodim::H5Layout& h5layout, const OdimStandard& odimStandard,
-                     const bool checkOptional, OdimStandard* failedEntries) {
+                     const MatchMatrix& matches, const bool checkOptional, OdimStandard* failedEntries) {
   bool isCompliant{true};
   
   if ( failedEntries ) failedEntries->entries.clear();
 
-  for (const auto& entry : odimStandard.entries) {
-    
+  // the found flags are set here, the workers only read the layout
+  std::vector<size_t> toCheck;
+  for (size_t iEntry=0; iEntry<odimStandard.entries.size(); ++iEntry) {
+    const OdimEntry& entry = odimStandard.entries[iEntry];
     if ( !checkOptional && !entry.isMandatory ) continue;
-    
-    bool entryExists{false};
-    
-    std::regex nodeRegex{entry.node};
-    std::string failedValueMessage;
-    
+    toCheck.push_back(iEntry);
     switch (entry.category) {
       case OdimEntry::Group :
-        for (auto& g : h5layout.groups) {
-          if ( std::regex_match(g.name(), nodeRegex) ) {
-            entryExists = true;
-            g.wasFound() = true;
-          }
-        }
+        for (const uint32_t k : matches.groups[iEntry]) h5layout.groups[k].wasFound() = true;
         break;
       case OdimEntry::Dataset :
-        for (auto& d : h5layout.datasets) {
-          if ( std::regex_match(d.name(), nodeRegex) ) {
-            entryExists = true;
-            d.wasFound() = true;
-            if ( h5layout.isUcharDataset(d.name()) ) {
-              if ( !h5layout.ucharDatasetHasImageAttributes(d.name()) ) {
-                isCompliant = false;
-                printWrongImageAttributes(entry);
-                if ( failedEntries ) {
-                  failedEntries->entries.push_back(
-                    OdimEntry(d.name()+"/CLASS", "Attribute", "String", "True",
-                             "IMAGE", "Section 5 in all ODIM-H5 version documents"));
-                  failedEntries->entries.push_back(
-                    OdimEntry(d.name()+"/IMAGE_VERSION", "Attribute", "String", "True",
-                             "1.2", "Section 5 in all ODIM-H5 version documents"));
-                }
-              }
+        for (const uint32_t k : matches.datasets[iEntry]) h5layout.datasets[k].wasFound() = true;
+        break;
+      case OdimEntry::Attribute :
+        for (const uint32_t k : matches.attributes[iEntry]) h5layout.attributes[k].wasFound() = true;
+        break;
+      default :
+        break;
+    }
+  }
+
+  // the values of the checked string attributes are read anyway because of the STRSIZE check - read them in one batch
+  std::vector<std::string> stringAttributes;
+  for (const size_t iEntry : toCheck) {
+    const OdimEntry& entry = odimStandard.entries[iEntry];
+    if ( entry.category != OdimEntry::Attribute || entry.type != OdimEntry::String ) continue;
+    for (const uint32_t k : matches.attributes[iEntry]) {
+      if ( h5layout.attributeInfoAt(k).typeClass == H5T_STRING ) stringAttributes.push_back(h5layout.attributes[k].name());
+    }
+  }
+  h5layout.loadAttributeValues(stringAttributes);
+
+  const std::vector<OdimRule>& rules = odimStandard.rules();
+  std::vector<EntryResult> results(toCheck.size());
+  const auto checkFrom = [&](std::atomic<size_t>* next) {
+    for (size_t i = (*next)++; i < toCheck.size(); i = (*next)++) {
+      EntryResult& result = results[i];
+      try {
+        result.isCompliant = checkEntry(h5layout, odimStandard.entries[toCheck[i]], rules[toCheck[i]],
+                                        matches, toCheck[i], result.out, &result.failed);
+      }
+      catch (...) {
+        result.error = std::current_exception();
+      }
+    }
+  };
+  std::atomic<size_t> next{0};
+  const size_t workers = std::min(workerCount(), toCheck.size()/MIN_ENTRIES_PER_WORKER);
+  if ( workers <= 1 ) {
+    checkFrom(&next);
+  }
+  else {
+    std::vector<std::thread> threads;
+    for (size_t i=0; i<workers; ++i) threads.emplace_back(checkFrom, &next);
+    for (auto& t : threads) t.join();
+  }
+
+  for (EntryResult& result : results) {
+    std::cout << result.out.str() << std::flush;
+    if ( failedEntries ) {
+      failedEntries->entries.insert(failedEntries->entries.end(),
+                                    result.failed.entries.begin(), result.failed.entries.end());
+    }
+    if ( result.error ) std::rethrow_exception(result.error);
+    isCompliant = isCompliant && result.isCompliant;
+  }
+  
+  return isCompliant;
+}
+
+bool checkEntry(const myodim::H5Layout& h5layout, const OdimEntry& entry, const OdimRule& rule,
+                const MatchMatrix& matches, const size_t iEntry, std::ostream& out,
+                OdimStandard* failedEntries) {
+  bool isCompliant{true};
+  bool entryExists{false};
+  std::string failedValueMessage;
+  
+  switch (entry.category) {
+    case OdimEntry::Group :
+      entryExists = !matches.groups[iEntry].empty();
+      break;
+    case OdimEntry::Dataset :
+      for (const uint32_t k : matches.datasets[iEntry]) {
+        const auto& d = h5layout.datasets[k];
+        entryExists = true;
+        if ( h5layout.isUcharDataset(d.name()) ) {
+          if ( !h5layout.ucharDatasetHasImageAttributes(d.name()) ) {
+            isCompliant = false;
+            printWrongImageAttributes(out, entry);
+            if ( failedEntries ) {
+              failedEntries->entries.push_back(
+                OdimEntry(d.name()+"/CLASS", "Attribute", "String", "True",
+                         "IMAGE", "Section 5 in all ODIM-H5 version documents"));
+              failedEntries->entries.push_back(
+                OdimEntry(d.name()+"/IMAGE_VERSION", "Attribute", "String", "True",
+                         "1.2", "Section 5 in all ODIM-H5 version documents"));
             }
           }
         }
-        break;
-      case OdimEntry::Attribute :
-        for (auto& a : h5layout.attributes) {
-          if ( std::regex_match(a.name(), nodeRegex) ) {
-            bool hasProperDatatype, hasProperValue;
-            entryExists = true;
-            a.wasFound() = true;
-            switch (entry.type) {
-              case OdimEntry::String : 
-                {
-                std::string errmsg = "";
-                hasProperDatatype = h5layout.isFixedLengthStringAttribute(a.name(), errmsg);
-                if ( !hasProperDatatype ) {
-                  isCompliant = false;
-                  printWrongTypeMessage(entry, a, errmsg);
-                  if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
-                  }
-                }
-                std::string value;
-                // load the value to see wether the size of it is good - it throws when not
-                try {
-                  h5layout.getAttributeValue(a.name(), value);
-                }
-                catch (const std::exception& e) {
-                  hasProperDatatype = false;
-                  std::string message(e.what());
-                  if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
-                  }
-                  if ( message.find("WARNING") != std::string::npos ) {
-                    std::cout << message << std::endl;
-                  }
-                  else {
-                    throw(e);
-                  }
-                }
-                if ( !entry.possibleValues.empty() ) {
-                  if ( hasProperDatatype ) {
-                    std::regex valueRegex{entry.possibleValues};
-                    hasProperValue = checkValue(value, entry.possibleValues, failedValueMessage);
-                    if ( !hasProperValue ) {
-                      isCompliant = false;
-                      printIncorrectValueMessage(entry, a, failedValueMessage);
-                      if ( failedEntries ) {
-                       OdimEntry eFailed = entry;
-                       eFailed.node = a.name();
-                       failedEntries->entries.push_back(eFailed);
-                      }
-                    }
-                    if ( a.name() == "/what/source" && hasProperValue ) {
-                      hasProperValue = checkWhatSource(value, entry.possibleValues, failedValueMessage);
-                      if ( !hasProperValue ) {
-                        isCompliant = false;
-                        printIncorrectValueMessage(entry, a, failedValueMessage);
-                        if ( failedEntries ) {
-                          OdimEntry eFailed = entry;
-                          eFailed.node = a.name();
-                          failedEntries->entries.push_back(eFailed);
-                        }
-                      }
-                    }
-                  }
-                }
-                }
-                break;
-              case OdimEntry::Real :
-                hasProperDatatype = h5layout.isReal64Attribute(a.name()) &&
-                                   !h5layout.is1DArrayAttribute(a.name());
-                if ( !hasProperDatatype ) {
-                  isCompliant = false;
-                  printWrongTypeMessage(entry, a);
-                  if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
-                  }
-                }
-                if ( !entry.possibleValues.empty() ) {
-                  double value=0.0;
-                  h5layout.getAttributeValue(a.name(), value);
-                  const bool isReal = true;
-                  hasProperValue = checkValue(value, entry.possibleValues, failedValueMessage, isReal);
-                  if ( !hasProperValue ) {
-                    isCompliant = false;
-                    printIncorrectValueMessage(entry, a, failedValueMessage);
-                    if ( failedEntries ) {
-                     OdimEntry eFailed = entry;
-                     eFailed.node = a.name();
-                     failedEntries->entries.push_back(eFailed);
-                    }
-                  }
-                }
-                break;
-              case OdimEntry::RealArray :
-                hasProperDatatype = h5layout.isReal64Attribute(a.name()) &&
-                                    h5layout.is1DArrayAttribute(a.name());
-                if ( !hasProperDatatype ) {
-                  isCompliant = false;
-                  printWrongTypeMessage(entry, a);
-                  if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
-                  }
-                }
-                if ( !entry.possibleValues.empty() ) {
-                  std::vector<double> values;
-                  h5layout.getAttributeValue(a.name(), values);
-                  hasProperValue = checkValue(values, entry.possibleValues, failedValueMessage);
-                  if ( !hasProperValue ) {
-                    isCompliant = false;
-                    printIncorrectValueMessage(entry, a, failedValueMessage);
-                    if ( failedEntries ) {
-                      OdimEntry eFailed = entry;
-                      eFailed.node = a.name();
-                      failedEntries->entries.push_back(eFailed);
-                    }
-                  }
-                }
-                break;
-              case OdimEntry::RealArray2D :
-                hasProperDatatype = h5layout.isReal64Attribute(a.name()) &&
-                                    h5layout.is2DArrayAttribute(a.name());
-                if ( !hasProperDatatype ) {
+      }
+      break;
+    case OdimEntry::Attribute :
+      for (const uint32_t k : matches.attributes[iEntry]) {
+        const auto& a = h5layout.attributes[k];
+        bool hasProperDatatype, hasProperValue;
+        entryExists = true;
+        switch (entry.type) {
+          case OdimEntry::String : 
+            {
+            std::string errmsg = "";
+            hasProperDatatype = h5layout.isFixedLengthStringAttribute(a.name(), errmsg);
+            if ( !hasProperDatatype ) {
+              isCompliant = false;
+              printWrongTypeMessage(out, entry, a, errmsg);
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+            }
+            std::string value;
+            // load the value to see wether the size of it is good
+            const h5Error error = h5layout.tryGetAttributeValue(a.name(), value);
+            if ( error ) {
+              hasProperDatatype = false;
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+              if ( error.isWarning() ) {
+                out << error.message << std::endl;
+              }
+              else {
+                throw std::runtime_error(error.message);
+              }
+            }
+            if ( !entry.possibleValues.empty() ) {
+              if ( hasProperDatatype ) {
+                hasProperValue = rule.hasValueRegex ?
+                                 checkValue(value, rule.valueRegex, entry.possibleValues, failedValueMessage) :
+                                 checkValue(value, entry.possibleValues, failedValueMessage);
+                if ( !hasProperValue ) {
                   isCompliant = false;
-                  printWrongTypeMessage(entry, a);
+                  printIncorrectValueMessage(out, entry, a, failedValueMessage);
                   if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
+                   OdimEntry eFailed = entry;
+                   eFailed.node = a.name();
+                   failedEntries->entries.push_back(eFailed);
                   }
                 }
-                if ( !entry.possibleValues.empty() ) {
-                  std::vector<double> values;
-                  h5layout.getAttributeValue(a.name(), values);
-                  hasProperValue = checkValue(values, entry.possibleValues, failedValueMessage);
+                if ( a.name() == "/what/source" && hasProperValue ) {
+                  hasProperValue = checkWhatSourceParts(value, failedValueMessage);  // the basic regex is already matched
                   if ( !hasProperValue ) {
                     isCompliant = false;
-                    printIncorrectValueMessage(entry, a, failedValueMessage);
+                    printIncorrectValueMessage(out, entry, a, failedValueMessage);
                     if ( failedEntries ) {
                       OdimEntry eFailed = entry;
                       eFailed.node = a.name();
@@ -325,307 +345,364 @@ bool checkCompliance(myodim::H5Layout& h5layout, const OdimStandard& odimStandar
                     }
                   }
                 }
-                break;
-              case OdimEntry::Integer :
-                hasProperDatatype = h5layout.isInt64Attribute(a.name()) &&
-                                   !h5layout.is1DArrayAttribute(a.name());
-                if ( !hasProperDatatype ) {
-                  isCompliant = false;
-                  printWrongTypeMessage(entry, a);
-                  if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
-                  }
-                }
-                if ( !entry.possibleValues.empty() ) {
-                  int64_t value=0;
-                  h5layout.getAttributeValue(a.name(), value);
-                  hasProperValue = checkValue(value, entry.possibleValues, failedValueMessage);
-                  if ( !hasProperValue ) {
-                    isCompliant = false;
-                    printIncorrectValueMessage(entry, a, failedValueMessage);
-                    if ( failedEntries ) {
-                      OdimEntry eFailed = entry;
-                      eFailed.node = a.name();
-                      failedEntries->entries.push_back(eFailed);
-                    }
-                  }
+              }
+            }
+            }
+            break;
+          case OdimEntry::Real :
+            hasProperDatatype = h5layout.isReal64Attribute(a.name()) &&
+                               !h5layout.is1DArrayAttribute(a.name());
+            if ( !hasProperDatatype ) {
+              isCompliant = false;
+              printWrongTypeMessage(out, entry, a);
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+            }
+            if ( !entry.possibleValues.empty() ) {
+              double value=0.0;
+              h5layout.getAttributeValue(a.name(), value);
+              const bool isReal = true;
+              hasProperValue = checkValue(value, rule.valueExpression, failedValueMessage, isReal);
+              if ( !hasProperValue ) {
+                isCompliant = false;
+                printIncorrectValueMessage(out, entry, a, failedValueMessage);
+                if ( failedEntries ) {
+                 OdimEntry eFailed = entry;
+                 eFailed.node = a.name();
+                 failedEntries->entries.push_back(eFailed);
                 }
-                break;
-              case OdimEntry::IntegerArray :
-                hasProperDatatype = h5layout.isInt64Attribute(a.name()) &&
-                                    h5layout.is1DArrayAttribute(a.name());
-                if ( !hasProperDatatype ) {
-                  isCompliant = false;
-                  printWrongTypeMessage(entry, a);
-                  if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
-                  }
+              }
+            }
+            break;
+          case OdimEntry::RealArray :
+            hasProperDatatype = h5layout.isReal64Attribute(a.name()) &&
+                                h5layout.is1DArrayAttribute(a.name());
+            if ( !hasProperDatatype ) {
+              isCompliant = false;
+              printWrongTypeMessage(out, entry, a);
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+            }
+            if ( !entry.possibleValues.empty() ) {
+              std::vector<double> values;
+              h5layout.getAttributeValue(a.name(), values);
+              hasProperValue = checkValue(values, rule.valueExpression, failedValueMessage);
+              if ( !hasProperValue ) {
+                isCompliant = false;
+                printIncorrectValueMessage(out, entry, a, failedValueMessage);
+                if ( failedEntries ) {
+                  OdimEntry eFailed = entry;
+                  eFailed.node = a.name();
+                  failedEntries->entries.push_back(eFailed);
                 }
-                if ( !entry.possibleValues.empty() ) {
-                  std::vector<int64_t> values;
-                  h5layout.getAttributeValue(a.name(), values);
-                  std::vector<double> dValues(values.size());
-                  for (int i=0, n=dValues.size(); i<n; ++i) dValues[i] = values[i];
-                  hasProperValue = checkValue(dValues, entry.possibleValues, failedValueMessage);
-                  if ( !hasProperValue ) {
-                    isCompliant = false;
-                    printIncorrectValueMessage(entry, a, failedValueMessage);
-                    if ( failedEntries ) {
-                      OdimEntry eFailed = entry;
-                      eFailed.node = a.name();
-                      failedEntries->entries.push_back(eFailed);
-                    }
-                  }
+              }
+            }
+            break;
+          case OdimEntry::RealArray2D :
+            hasProperDatatype = h5layout.isReal64Attribute(a.name()) &&
+                                h5layout.is2DArrayAttribute(a.name());
+            if ( !hasProperDatatype ) {
+              isCompliant = false;
+              printWrongTypeMessage(out, entry, a);
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+            }
+            if ( !entry.possibleValues.empty() ) {
+              std::vector<double> values;
+              h5layout.getAttributeValue(a.name(), values);
+              hasProperValue = checkValue(values, rule.valueExpression, failedValueMessage);
+              if ( !hasProperValue ) {
+                isCompliant = false;
+                printIncorrectValueMessage(out, entry, a, failedValueMessage);
+                if ( failedEntries ) {
+                  OdimEntry eFailed = entry;
+                  eFailed.node = a.name();
+                  failedEntries->entries.push_back(eFailed);
                 }
-                break;
-              case OdimEntry::IntegerArray2D :
-                hasProperDatatype = h5layout.isInt64Attribute(a.name()) &&
-                                    h5layout.is2DArrayAttribute(a.name());
-                if ( !hasProperDatatype ) {
-                  isCompliant = false;
-                  printWrongTypeMessage(entry, a);
-                  if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
-                  }
+              }
+            }
+            break;
+          case OdimEntry::Integer :
+            hasProperDatatype = h5layout.isInt64Attribute(a.name()) &&
+                               !h5layout.is1DArrayAttribute(a.name());
+            if ( !hasProperDatatype ) {
+              isCompliant = false;
+              printWrongTypeMessage(out, entry, a);
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+            }
+            if ( !entry.possibleValues.empty() ) {
+              int64_t value=0;
+              h5layout.getAttributeValue(a.name(), value);
+              hasProperValue = checkValue(value, rule.valueExpression, failedValueMessage);
+              if ( !hasProperValue ) {
+                isCompliant = false;
+                printIncorrectValueMessage(out, entry, a, failedValueMessage);
+                if ( failedEntries ) {
+                  OdimEntry eFailed = entry;
+                  eFailed.node = a.name();
+                  failedEntries->entries.push_back(eFailed);
                 }
-                if ( !entry.possibleValues.empty() ) {
-                  std::vector<int64_t> values;
-                  h5layout.getAttributeValue(a.name(), values);
-                  std::vector<double> dValues(values.size());
-                  for (int i=0, n=dValues.size(); i<n; ++i) dValues[i] = values[i];
-                  hasProperValue = checkValue(dValues, entry.possibleValues, failedValueMessage);
-                  if ( !hasProperValue ) {
-                    isCompliant = false;
-                    printIncorrectValueMessage(entry, a, failedValueMessage);
-                    if ( failedEntries ) {
-                      OdimEntry eFailed = entry;
-                      eFailed.node = a.name();
-                      failedEntries->entries.push_back(eFailed);
-                    }
-                  }
+              }
+            }
+            break;
+          case OdimEntry::IntegerArray :
+            hasProperDatatype = h5layout.isInt64Attribute(a.name()) &&
+                                h5layout.is1DArrayAttribute(a.name());
+            if ( !hasProperDatatype ) {
+              isCompliant = false;
+              printWrongTypeMessage(out, entry, a);
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+            }
+            if ( !entry.possibleValues.empty() ) {
+              std::vector<int64_t> values;
+              h5layout.getAttributeValue(a.name(), values);
+              hasProperValue = checkValue(values, rule.valueExpression, failedValueMessage);
+              if ( !hasProperValue ) {
+                isCompliant = false;
+                printIncorrectValueMessage(out, entry, a, failedValueMessage);
+                if ( failedEntries ) {
+                  OdimEntry eFailed = entry;
+                  eFailed.node = a.name();
+                  failedEntries->entries.push_back(eFailed);
                 }
-                break;
-              case OdimEntry::Link :
-                hasProperDatatype = h5layout.isLinkAttribute(a.name());
-                if ( !hasProperDatatype ) {
-                  isCompliant = false;
-                  printWrongTypeMessage(entry, a);
-                  if ( failedEntries ) {
-                    OdimEntry eFailed = entry;
-                    eFailed.node = a.name();
-                    failedEntries->entries.push_back(eFailed);
-                  }
+              }
+            }
+            break;
+          case OdimEntry::IntegerArray2D :
+            hasProperDatatype = h5layout.isInt64Attribute(a.name()) &&
+                                h5layout.is2DArrayAttribute(a.name());
+            if ( !hasProperDatatype ) {
+              isCompliant = false;
+              printWrongTypeMessage(out, entry, a);
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+            }
+            if ( !entry.possibleValues.empty() ) {
+              std::vector<int64_t> values;
+              h5layout.getAttributeValue(a.name(), values);
+              hasProperValue = checkValue(values, rule.valueExpression, failedValueMessage);
+              if ( !hasProperValue ) {
+                isCompliant = false;
+                printIncorrectValueMessage(out, entry, a, failedValueMessage);
+                if ( failedEntries ) {
+                  OdimEntry eFailed = entry;
+                  eFailed.node = a.name();
+                  failedEntries->entries.push_back(eFailed);
                 }
-              default :
-                break;
+              }
             }
-          }
-        }
-        break;
-      default :
-        break;
-    }
-    
-    if ( !entryExists ) {
-      if ( entry.isMandatory) {
-        isCompliant = false;
-        std::cout << "WARNING - MISSING ENTRY - mandatory entry \"" << entry.node <<
-                     "\" doesn`t exist in the file.";
-        if ( !entry.reference.empty() ) std::cout << " See " << entry.reference;
-        std::cout << std::endl;
-        if ( failedEntries ) {
-          OdimEntry eFailed = entry;
-          failedEntries->entries.push_back(eFailed);
+            break;
+          case OdimEntry::Link :
+            hasProperDatatype = h5layout.isLinkAttribute(a.name());
+            if ( !hasProperDatatype ) {
+              isCompliant = false;
+              printWrongTypeMessage(out, entry, a);
+              if ( failedEntries ) {
+                OdimEntry eFailed = entry;
+                eFailed.node = a.name();
+                failedEntries->entries.push_back(eFailed);
+              }
+            }
+          default :
+            break;
         }
       }
-      else {
-        if ( printInfo ) {
-          std::cout << "INFO - optional entry \"" << entry.node <<
-                       "\" doesn`t exist in the file.";
-          if ( !entry.reference.empty() ) std::cout << " See " << entry.reference;
-          std::cout << std::endl;
-        }
+      break;
+    default :
+      break;
+  }
+  
+  if ( !entryExists ) {
+    if ( entry.isMandatory) {
+      isCompliant = false;
+      out << "WARNING - MISSING ENTRY - mandatory entry \"" << entry.node <<
+             "\" doesn`t exist in the file.";
+      if ( !entry.reference.empty() ) out << " See " << entry.reference;
+      out << std::endl;
+      if ( failedEntries ) {
+        OdimEntry eFailed = entry;
+        failedEntries->entries.push_back(eFailed);
+      }
+    }
+    else {
+      if ( printInfo ) {
+        out << "INFO - optional entry \"" << entry.node <<
+               "\" doesn`t exist in the file.";
+        if ( !entry.reference.empty() ) out << " See " << entry.reference;
+        out << std::endl;
       }
     }
-    
   }
-  
+
   return isCompliant;
 }
 
-bool checkExtraFeatures(const myodim::H5Layout& h5layout, const OdimStandard& odimStandard) {
+// every object is classified as known or extra from the match matrix in one pass, the type diagnostics
+// of the extra attributes use the type info recorded in explore and one batched read of the string values
+bool checkExtraFeatures(myodim::H5Layout& h5layout, const OdimStandard& odimStandard,
+                        const MatchMatrix& matches) {
   bool extrasPresent{false};
+
+  // an object is known when some entry of its category matches it
+  std::vector<bool> isKnownGroup(h5layout.groups.size(), false);
+  std::vector<bool> isKnownDataset(h5layout.datasets.size(), false);
+  std::vector<bool> isKnownAttribute(h5layout.attributes.size(), false);
+  for (size_t i=0; i<odimStandard.entries.size(); ++i) {
+    switch (odimStandard.entries[i].category) {
+      case OdimEntry::Group :
+        for (const uint32_t k : matches.groups[i]) isKnownGroup[k] = true;
+        break;
+      case OdimEntry::Dataset :
+        for (const uint32_t k : matches.datasets[i]) isKnownDataset[k] = true;
+        break;
+      case OdimEntry::Attribute :
+        for (const uint32_t k : matches.attributes[i]) isKnownAttribute[k] = true;
+        break;
+      default :
+        break;
+    }
+  }
   
-  for (const auto& group : h5layout.groups) {
+  for (size_t k=0; k<h5layout.groups.size(); ++k) {
+    const auto& group = h5layout.groups[k];
     if ( group.wasFound() ) continue;
-    bool isExtra{true};
-    for (const auto& entry : odimStandard.entries) {
-      if ( entry.category != OdimEntry::Group ) continue;
-      std::regex nodeRegex{entry.node};
-      if ( std::regex_match(group.name(), nodeRegex) ) isExtra = false;
-    }
+    const bool isExtra = !isKnownGroup[k];
     if ( isExtra ) {
       if ( printInfo) std::cout << "INFO - extra feature - entry \"" + group.name() + "\" is not mentioned in the standard." << std::endl;
       extrasPresent = true;
     }
   }
   
-  for (const auto& dataset : h5layout.datasets) {
+  for (size_t k=0; k<h5layout.datasets.size(); ++k) {
+    const auto& dataset = h5layout.datasets[k];
     if ( dataset.wasFound() ) continue;
-    bool isExtra{true};
-    for (const auto& entry : odimStandard.entries) {
-      if ( entry.category != OdimEntry::Dataset ) continue;
-      std::regex nodeRegex{entry.node};
-      if ( std::regex_match(dataset.name(), nodeRegex) ) isExtra = false;
-    }
+    const bool isExtra = !isKnownDataset[k];
     if ( isExtra ) {
       if ( printInfo) std::cout << "INFO - extra feature - entry \"" + dataset.name() + "\" is not mentioned in the standard." << std::endl;
       extrasPresent = true;
     }
   }
+
+  std::vector<size_t> extraAttributes;
+  std::vector<std::string> stringsToRead;   // only their STRSIZE is checked
+  std::string errmsg;
+  for (size_t k=0; k<h5layout.attributes.size(); ++k) {
+    if ( h5layout.attributes[k].wasFound() || isKnownAttribute[k] ) continue;
+    extraAttributes.push_back(k);
+    if ( h5layout.attributeInfoAt(k).isFixedLengthString(errmsg) ) stringsToRead.push_back(h5layout.attributes[k].name());
+  }
+  if ( !stringsToRead.empty() ) h5layout.loadAttributeValues(stringsToRead);
   
-  for (const auto& attribute : h5layout.attributes) {
-    if ( attribute.wasFound() ) continue;
-    bool isExtra{true};
-    for (const auto& entry : odimStandard.entries) {
-      if ( entry.category != OdimEntry::Attribute ) continue;
-      std::regex nodeRegex{entry.node};
-      if ( std::regex_match(attribute.name(), nodeRegex) ) isExtra = false;
-    }
-    if ( isExtra ) {
-      if ( printInfo) std::cout << "INFO - extra feature - entry \"" + attribute.name() + "\" is not mentioned in the standard." << std::endl;
-      extrasPresent = true;
-      if ( h5layout.isInt64Attribute(attribute.name()) ) {
-        ;
-      }
-      else if ( h5layout.isReal64Attribute(attribute.name()) ) {
-        ;
-      }
-      else if ( h5layout.isStringAttribute(attribute.name()) ) {
-        std::string errmsg = "";
-        if ( !h5layout.isFixedLengthStringAttribute(attribute.name(), errmsg) ) {
-          std::cout << "WARNING - extra feature - entry \"" + attribute.name() + "\" has non-standard datatype - " << errmsg << std::endl;
-        }
-        else {
-          std::string val;
-          try {
-            h5layout.getAttributeValue(attribute.name(), val);
-          }
-          catch (const std::exception& e) {
-            const std::string msg = e.what();
-            if ( msg.find("WARNING") != std::string::npos ) {
-              std::cout << msg << std::endl;
-            }
-          }
-        }
+  for (const size_t k : extraAttributes) {
+    const std::string attrName = h5layout.attributes[k].name();
+    const h5AttributeInfo& info = h5layout.attributeInfoAt(k);
+    if ( printInfo) std::cout << "INFO - extra feature - entry \"" + attrName + "\" is not mentioned in the standard." << std::endl;
+    extrasPresent = true;
+    if ( info.typeClass == H5T_INTEGER && info.precision == 64 ) {
+      ;
+    }
+    else if ( info.typeClass == H5T_FLOAT && info.precision == 64 ) {
+      ;
+    }
+    else if ( info.typeClass == H5T_STRING ) {
+      errmsg = "";
+      if ( !info.isFixedLengthString(errmsg) ) {
+        std::cout << "WARNING - extra feature - entry \"" + attrName + "\" has non-standard datatype - " << errmsg << std::endl;
       }
       else {
-        std::cout << "WARNING - extra feature - entry \"" + attribute.name() + "\" has non-standard datatype " << std::endl;
+        std::string val;
+        const h5Error error = h5layout.tryGetAttributeValue(attrName, val);
+        if ( error.isWarning() ) {
+          std::cout << error.message << std::endl;
+        }
       }
     }
+    else {
+      std::cout << "WARNING - extra feature - entry \"" + attrName + "\" has non-standard datatype " << std::endl;
+    }
   }
   
   return extrasPresent;
 }
 
 bool checkMandatoryExistenceInAll(myodim::H5Layout& h5layout, const OdimStandard& odimStandard,
-                                  OdimStandard* failedEntries) {
+                                  const MatchMatrix& matches, OdimStandard* failedEntries) {
   bool isCompliant = true;
 
-  for (const auto& entry : odimStandard.entries) {
+  // the tree nodes of the parents of the objects matching a parent pattern and of those matching the node,
+  // the flags are reset after each entry, so the work is linear in the matched objects
+  const H5PathTrie& paths = h5layout.paths();
+  std::vector<uint32_t> parents;
+  std::vector<bool> isParent(paths.size(), false);
+  std::vector<uint32_t> entryParents;
+  std::vector<bool> hasEntry(paths.size(), false);
+
+  const std::vector<OdimRule>& rules = odimStandard.rules();
+  for (size_t iEntry=0; iEntry<odimStandard.entries.size(); ++iEntry) {
+    const OdimEntry& entry = odimStandard.entries[iEntry];
+    const OdimRule& rule = rules[iEntry];
 
     if ( !entry.isMandatory ) continue;
 
     //if node contains some wildcard, check ALL h5layout elements which fulfill the given regex
-    if ( entry.node.find('*') != std::string::npos ||
-         entry.node.find('[') != std::string::npos ||
-         entry.node.find('?') != std::string::npos ) {
-      //std::cout << "DBG - processing a wildcard enrty: " << entry.node << std::endl;
-      std::string parent{""}, child{""};
-      splitNodePath(entry.node, parent, child);
-      //std::cout << "DBG - parent = " << parent << ", child = " << child << std::endl;
-      if ( parent.empty() ) continue;
-
-      std::regex nodeRegex{entry.node};
-      std::string parentEnxtended = parent + "/[0-z]*";
-      //std::cout << "DBG - parentEnxtended = " << parentEnxtended << std::endl;
-      std::regex parentRegex{parentEnxtended};
-
-      std::vector<std::string> parents;
-      std::vector<std::string> entries;
+    if ( rule.hasWildcard ) {
+      //the parent extended by any child - parent + "/[0-z]*"
+      if ( !rule.hasParentRegex ) continue;
+
+      const size_t iParent = odimStandard.entries.size()+iEntry;   // ID of the parent pattern in the automaton
+
+      const auto addParentsOf = [&paths](const std::vector<h5Entry>& objects, const std::vector<uint32_t>& indexes,
+                                         std::vector<uint32_t>& list, std::vector<bool>& isInList) {
+        for (const uint32_t k : indexes) {
+          const uint32_t p = paths.parent(objects[k].node());
+          if ( p == H5PathTrie::NO_NODE || isInList[p] ) continue;
+          isInList[p] = true;
+          list.push_back(p);
+        }
+      };
       switch (entry.category) {
         case OdimEntry::Group :
-          for (auto& g : h5layout.groups) {
-            if ( std::regex_match(g.name(), parentRegex)  ) {
-              std::string p, c;
-              splitNodePath(g.name(), p, c);
-              addIfUnique(parents, p);
-            }
-            if ( std::regex_match(g.name(), nodeRegex)  ) {
-              std::string p, c;
-              splitNodePath(g.name(), p, c);
-              addIfUnique(entries, p);
-            }
-          }
+          addParentsOf(h5layout.groups, matches.groups[iParent], parents, isParent);
+          addParentsOf(h5layout.groups, matches.groups[iEntry], entryParents, hasEntry);
           break;
         case OdimEntry::Dataset :
-          for (auto& d : h5layout.datasets) {
-            if ( std::regex_match(d.name(), parentRegex) ) {
-              std::string p, c;
-              splitNodePath(d.name(), p, c);
-              addIfUnique(parents, p);
-            }
-            if ( std::regex_match(d.name(), nodeRegex)  ) {
-              std::string p, c;
-              splitNodePath(d.name(), p, c);
-              addIfUnique(entries, p);
-            }
-          }
+          addParentsOf(h5layout.datasets, matches.datasets[iParent], parents, isParent);
+          addParentsOf(h5layout.datasets, matches.datasets[iEntry], entryParents, hasEntry);
           break;
         case OdimEntry::Attribute :
-          //std::cout << "DBG - searching for attribute ..." << std::endl;
-          for (auto& a : h5layout.attributes) {
-            //std::cout << "DBG - a.name = " << a.name() << ", parentRegex = " << parentEnxtended << std::endl;
-            if ( std::regex_match(a.name(), parentRegex) ) {
-              //std::cout << "DBG - match " << std::endl;
-              std::string p, c;
-              splitNodePath(a.name(), p, c);
-              addIfUnique(parents, p);
-            }
-            //std::cout << "DBG - a.name = " << a.name() << ", nodeRegex = " << entry.node << std::endl;
-            if ( std::regex_match(a.name(), nodeRegex)  ) {
-              //std::cout << "DBG - match " << std::endl;
-              std::string p, c;
-              splitNodePath(a.name(), p, c);
-              addIfUnique(entries, p);
-            }
-          }
+          addParentsOf(h5layout.attributes, matches.attributes[iParent], parents, isParent);
+          addParentsOf(h5layout.attributes, matches.attributes[iEntry], entryParents, hasEntry);
           break;
         default:
           break;
       }
 
-      /*
-      std::cout << "dbg - parents to search: ";
-      for (const auto& p : parents) {
-        std::cout << p << " ";
-      }
-      std::cout << std::endl;
-      std::cout << "dbg - entries found: ";
-      for (const auto& e : entries) {
-        std::cout << e << " ";
-      }
-      std::cout << std::endl;
-      */
+      const bool entryFound = entryFoundInDocTree(paths, parents, hasEntry);
 
-      const bool entryFound = entryFoundInDocTree(parents, entries);
-      //std::cout << "DBG - entryFoundInDocTree = " << entryFound << std::endl;
+      for (const uint32_t p : parents) isParent[p] = false;
+      for (const uint32_t p : entryParents) hasEntry[p] = false;
+      parents.clear();
+      entryParents.clear();
 
       if ( entryFound ) {
         ; //it is fine, do nothing
@@ -645,20 +722,6 @@ bool checkMandatoryExistenceInAll(myodim::H5Layout& h5layout, const OdimStandard
   return isCompliant;
 }
 
-void splitNodePath(const std::string& node, std::string& parent, std::string& child) {
-  const auto splitPosi = node.rfind('/');
-  if ( splitPosi == std::string::npos ) return;
-  parent = node.substr(0,splitPosi);
-  child = node.substr(splitPosi+1);
-}
-
-void addIfUnique(std::vector<std::string>& list, const std::string& str) {
-  for (const auto& element : list) {
-    if ( element == str ) return;
-  }
-  list.push_back(str);
-}
-
 bool isStringValue(const std::string& value) {
   return std::find_if(value.begin(), value.end(), isalpha) != value.end();
 }
@@ -669,7 +732,12 @@ bool hasDoublePoint(const std::string& value) {
 
 bool checkValue(const std::string& attrValue, const std::string& assumedValueStr,
                 std::string& errorMessage) {
-  std::regex valueRegex{assumedValueStr};
+  const std::regex valueRegex{assumedValueStr};
+  return checkValue(attrValue, valueRegex, assumedValueStr, errorMessage);
+}
+
+bool checkValue(const std::string& attrValue, const std::regex& valueRegex, const std::string& assumedValueStr,
+                std::string& errorMessage) {
   bool hasProperValue = std::regex_match(attrValue, valueRegex);
   if ( !hasProperValue ) {
     errorMessage = "with value \"" + attrValue + "\" doesn`t match the \"" +
@@ -680,143 +748,51 @@ bool checkValue(const std::string& attrValue, const std::string& assumedValueStr
 
 bool checkValue(const double attrValue, const std::string& assumedValueStr,
                 std::string& errorMessage, const bool isReal) {
-  errorMessage.clear();
-  bool hasProperValue;
-  if ( hasIntervalSigns(assumedValueStr) ) {
-
-    std::vector<std::string> comparisons;
-    std::vector<std::string> operators;
-    parseAssumedValueStr(assumedValueStr, comparisons, operators);
-
-    hasProperValue = checkValueInterval(attrValue, comparisons[0]);
-    for (int i=0, n=operators.size(); i<n; ++i) {
-      bool nextHasProperValue = checkValueInterval(attrValue, comparisons[i+1]);
-      if ( operators[i] == "&&" ) {
-        hasProperValue = hasProperValue && nextHasProperValue;
-      }
-      else {
-        hasProperValue = hasProperValue || nextHasProperValue;
-      }
-    }
-
-  }
-  else {
-
-    const double assumedValue = std::stod(assumedValueStr);
-    hasProperValue = std::fabs(attrValue - assumedValue) < MAX_DOUBLE_DIFF;
+  return checkValue(attrValue, ValueExpression{assumedValueStr}, errorMessage, isReal);
+}
 
-  }
+bool checkValue(const std::vector<double>& attrValues, const std::string& assumedValueStr,
+                std::string& errorMessage) {
+  const bool isArray = true;
+  return checkValue(attrValues, ValueExpression{assumedValueStr, isArray}, errorMessage);
+}
 
+bool checkValue(const double attrValue, const ValueExpression& assumedValue,
+                std::string& errorMessage, const bool isReal) {
+  errorMessage.clear();
+  const bool hasProperValue = assumedValue.evaluate(attrValue);
   if ( !hasProperValue ) {
-    const std::string attrValueStr = hasDoublePoint(assumedValueStr) || isReal ?
+    const std::string attrValueStr = hasDoublePoint(assumedValue.source()) || isReal ?
                                      std::to_string(attrValue) :
                                      std::to_string((int)attrValue);
     errorMessage = "with value \"" + attrValueStr +
-                   "\" doesn`t match the \"" + assumedValueStr + "\" assumed value";
+                   "\" doesn`t match the \"" + assumedValue.source() + "\" assumed value";
   }
-
   return hasProperValue;
 }
 
-bool checkValue(const std::vector<double>& attrValues, const std::string& assumedValueStr,
+bool checkValue(const std::vector<double>& attrValues, const ValueExpression& assumedValue,
                 std::string& errorMessage) {
   errorMessage.clear();
-  bool hasProperValue = false;
-
-  if ( hasIntervalSigns(assumedValueStr) ) {
-
-    double first, last, min, max, mean;
-    getArrayStatistics(attrValues, first, last, min ,max, mean);
-
-    std::vector<std::string> comparisons;
-    std::vector<std::string> operators;
-    parseAssumedValueStr(assumedValueStr, comparisons, operators);
-
-    double value = valueFromStatistics(comparisons[0], first, last, min ,max, mean);
-    hasProperValue = checkValueInterval(value, comparisons[0]);
-    for (int i=0, n=operators.size(); i<n; ++i) {
-      value = valueFromStatistics(comparisons[i+1], first, last, min ,max, mean);
-      bool nextHasProperValue = checkValueInterval(value, comparisons[i+1]);
-      if ( operators[i] == "&&" ) {
-        hasProperValue = hasProperValue && nextHasProperValue;
-      }
-      else {
-        hasProperValue = hasProperValue || nextHasProperValue;
-      }
-    }
-
-  }
-  else {
-    throw std::runtime_error("ERROR - wrong assumed value string \"" + assumedValueStr + "\" - " +
-                             "assumed value string for array attributes should use "+
-                             "logical operators and statistics (e.g. min<=1.000 or mean==5.0 or first>1.0&&last<10.0 ...)");
-  }
-
+  const bool hasProperValue = assumedValue.evaluate(attrValues);
   if ( !hasProperValue ) {
     errorMessage = "with array value \"[" + std::to_string(attrValues.front()) + ",...," +
                    std::to_string(attrValues.back()) + "]\" doesn`t match the \"" +
-                   assumedValueStr + "\" assumed value";
+                   assumedValue.source() + "\" assumed value";
   }
-
   return hasProperValue;
 }
 
-bool hasIntervalSigns(const std::string& assumedValueStr) {
-  return assumedValueStr.find('=') != std::string::npos ||
-         assumedValueStr.find('<') != std::string::npos ||
-         assumedValueStr.find('>') != std::string::npos ||
-         assumedValueStr.find("+-") != std::string::npos;
-}
-
-bool checkValueInterval(const double attrValue, const std::string& assumedValueStr) {
-  //get first sign and number
-  std::string signStr, numberStr;
-  bool hasPlusMinus = false;
-  for (int i=0; i<(int)assumedValueStr.length(); ++i) {
-    if ( (assumedValueStr[i] >= '0' && assumedValueStr[i] <= '9') || assumedValueStr[i] <= '.' ) {
-      numberStr.append(1, assumedValueStr[i]);
-      if ( assumedValueStr[i] == '-' && i > 0 && assumedValueStr[i-1] == '+') {
-        hasPlusMinus = true;
-      }
-    }
-    else {
-      signStr.append(1, assumedValueStr[i]);
-    }
-  }
-
-  bool result = false;
-
-  if ( hasPlusMinus ) {
-    double center, interval;
-    splitPlusMinus(numberStr, center, interval);
-
-    result = attrValue >= center-interval && attrValue <= center+interval;
-  }
-  else {
-    const double theNumber = numberStr.empty() ? std::nan("") : std::stod(numberStr);
-
-    if ( signStr == "=" || signStr == "==" ) {
-      result = std::fabs(attrValue - theNumber) < MAX_DOUBLE_DIFF;
-    }
-    else if ( signStr == "<=" ) {
-      result = attrValue <= theNumber;
-    }
-    else if ( signStr == "<" ) {
-      result = attrValue < theNumber;
-    }
-    else if ( signStr == ">=" ) {
-      result = attrValue >= theNumber;
-    }
-    else if ( signStr == ">" ) {
-      result = attrValue > theNumber;
-    }
-    else {
-      throw std::runtime_error("ERROR - unknown sign in the "+
-                               assumedValueStr+" PossibleValues string");
-    }
+bool checkValue(const std::vector<int64_t>& attrValues, const ValueExpression& assumedValue,
+                std::string& errorMessage) {
+  errorMessage.clear();
+  const bool hasProperValue = assumedValue.evaluate(attrValues);
+  if ( !hasProperValue ) {
+    errorMessage = "with array value \"[" + std::to_string(static_cast<double>(attrValues.front())) + ",...," +
+                   std::to_string(static_cast<double>(attrValues.back())) + "]\" doesn`t match the \"" +
+                   assumedValue.source() + "\" assumed value";
   }
-
-  return result;
+  return hasProperValue;
 }
 
 bool checkWhatSource(const std::string& whatSource, const std::string& basicRegex,
@@ -827,65 +803,107 @@ bool checkWhatSource(const std::string& whatSource, const std::string& basicRege
 }
 
 bool checkWhatSourceParts(const std::string& whatSource, std::string& errorMessage) {
-  bool result = false;
-
-  std::vector<std::string> whatSourceParts = splitString(whatSource, ",");
-  result = !whatSourceParts.empty();
-  for (const auto& id : whatSourceParts) {
-    std::string idErrorMessage = "";
-    if ( id.find("WMO") != std::string::npos ) {
-      result = result && checkValue(id, WMO_REGEX, idErrorMessage);
-    }
-    else if ( id.find("NOD") != std::string::npos ) {
-      result = result && checkValue(id, NOD_REGEX, idErrorMessage);
-    }
-    else if ( id.find("RAD") != std::string::npos ) {
-      result = result && checkValue(id, RAD_REGEX, idErrorMessage);
-    }
-    else if ( id.find("PLC") != std::string::npos ) {
-      result = result && checkValue(id, PLC_REGEX, idErrorMessage);
-    }
-    else if ( id.find("ORG") != std::string::npos ) {
-      result = result && checkValue(id, ORG_REGEX, idErrorMessage);
-    }
-    else if ( id.find("CTY") != std::string::npos ) {
-      result = result && checkValue(id, CTY_REGEX, idErrorMessage);
-    }
-    else if ( id.find("CMT") != std::string::npos ) {
-      result = result && checkValue(id, CMT_REGEX, idErrorMessage);
-    }
-    else if ( id.find("WIGOS") != std::string::npos ) {
-      result = result && checkValue(id, WIGOS_REGEX, idErrorMessage);
-    }
-    else {
-      idErrorMessage = "source type in /what/source - " + id + " - not defined by the ODIM standard";
-      result = result && false;
-    }
+  WhatSource parsed;
+  return parseWhatSource(whatSource, parsed, errorMessage);
+}
 
-    if ( !idErrorMessage.empty() ) errorMessage += idErrorMessage;
+bool parseWhatSource(const std::string& whatSource, WhatSource& parsed, std::string& errorMessage) {
+  parsed = WhatSource();
+  bool result = true;
+  size_t begin = 0;
+  while ( true ) {
+    size_t end = whatSource.find(',', begin);
+    if ( end == std::string::npos ) end = whatSource.size();
+    if ( !parseWhatSourceId(whatSource, begin, end, parsed, errorMessage) ) result = false;
+    if ( end == whatSource.size() ) break;
+    begin = end + 1;
   }
   return result;
 }
 
-std::vector<std::string> splitString(std::string str, const std::string& delimiter) {
-  std::vector<std::string> result;
-  if ( str.find(delimiter) == std::string::npos ) {
-    result.push_back(str);
+// one KEY:value identifier of /what/source, the spaces after the comma are accepted - e.g. "ORG:215, CTY:644"
+bool parseWhatSourceId(const std::string& whatSource, size_t begin, const size_t end,
+                       WhatSource& parsed, std::string& errorMessage) {
+  struct IdSyntax {
+    const char* key;
+    std::string WhatSource::* field;
+    bool (*isValid)(const std::string&);
+    const char* syntax;   // the rule checked by isValid, as printed in the messages
+  };
+  static const IdSyntax ids[] = {
+    {"WMO", &WhatSource::wmo, isWmoId, "WMO:<5 or 7 digits>"},
+    {"NOD", &WhatSource::nod, isAsciiId, "NOD:<ascii>"},
+    {"RAD", &WhatSource::rad, isAnyId, "RAD:<any>"},
+    {"PLC", &WhatSource::plc, isAnyId, "PLC:<any>"},
+    {"ORG", &WhatSource::org, isNumberId, "ORG:<digits>"},
+    {"CTY", &WhatSource::cty, isNumberId, "CTY:<digits>"},
+    {"CMT", &WhatSource::cmt, isAnyId, "CMT:<any>"},
+    {"WIGOS", &WhatSource::wigos, isWigosId, "WIGOS:<n>-<n>-<n>-<ascii id>"}
+  };
+
+  const size_t idBegin = begin;
+  while ( begin < end && whatSource[begin] == ' ' ) ++begin;
+  const size_t colon = whatSource.find(':', begin);
+  if ( colon < end ) {
+    const size_t keySize = colon - begin;
+    for (const auto& id : ids) {
+      if ( whatSource.compare(begin, keySize, id.key) != 0 ) continue;
+      const std::string value = whatSource.substr(colon+1, end-colon-1);
+      if ( !id.isValid(value) ) {
+        errorMessage += "with value \"" + whatSource.substr(idBegin, end-idBegin) + "\" doesn`t match the \"" +
+                        id.syntax + "\" assumed value";
+        return false;
+      }
+      parsed.*id.field = value;
+      return true;
+    }
   }
-  else {
-    size_t pos = 0;
-    std::string token;
-    while ((pos = str.find(delimiter)) != std::string::npos) {
-      token = str.substr(0, pos);
-      result.push_back(token);
-      str.erase(0, pos + delimiter.length());
+  errorMessage += "source type in /what/source - " + whatSource.substr(idBegin, end-idBegin) +
+                  " - not defined by the ODIM standard";
+  return false;
+}
+
+bool isAnyId(const std::string& /*value*/) {
+  return true;
+}
+
+bool isAsciiId(const std::string& value) {
+  return std::all_of(value.begin(), value.end(),
+                     [](const char c) { return static_cast<unsigned char>(c) < 0x80; });
+}
+
+bool isNumberId(const std::string& value) {
+  return !value.empty() && std::all_of(value.begin(), value.end(),
+                                       [](const char c) { return c >= '0' && c <= '9'; });
+}
+
+bool isWmoId(const std::string& value) {
+  return (value.size() == 5 || value.size() == 7) && isNumberId(value);
+}
+
+// the WIGOS station identifier - series, issuer and issue numbers and the local identifier
+bool isWigosId(const std::string& value) {
+  int dashes = 0;
+  size_t partSize = 0;
+  for (const char c : value) {
+    if ( dashes == 3 ) {
+      if ( static_cast<unsigned char>(c) >= 0x80 ) return false;
+    }
+    else if ( c == '-' && partSize > 0 ) {
+      ++dashes;
+      partSize = 0;
+      continue;
+    }
+    else if ( c < '0' || c > '9' ) {
+      return false;
     }
-    result.push_back(str);
+    ++partSize;
   }
-  return result;
+  return dashes == 3 && partSize > 0;
 }
 
-void printWrongTypeMessage(const OdimEntry& entry, const h5Entry& attr, const std::string errmsg) {
+void printWrongTypeMessage(std::ostream& out, const OdimEntry& entry, const h5Entry& attr,
+                           const std::string errmsg) {
   std::string message = "WARNING - NON-STANDARD DATA TYPE - ";
   message += entry.isMandatory ? "mandatory" : "optional";
   switch (entry.type) {
@@ -917,172 +935,46 @@ void printWrongTypeMessage(const OdimEntry& entry, const h5Entry& attr, const st
     default :
       break;
   }
-  std::cout << message << std::endl;
+  out << message << std::endl;
 }
 
-void printIncorrectValueMessage(const OdimEntry& entry, const h5Entry& attr,
+void printIncorrectValueMessage(std::ostream& out, const OdimEntry& entry, const h5Entry& attr,
                                 const std::string& failedValueMessage) {
   std::string message = "WARNING - INCORRECT VALUE - ";
   message += entry.isMandatory ? "mandatory" : "optional";
   message += " entry \"" + attr.name() + "\" " + failedValueMessage + ".";
-  std::cout << message << std::endl;
+  out << message << std::endl;
 }
 
-void printWrongImageAttributes(const OdimEntry& entry) {
+void printWrongImageAttributes(std::ostream& out, const OdimEntry& entry) {
   std::string message = "WARNING -  dataset \"" + entry.node + "\"  is 8-bit unsigned int - " +
                         "it should have attributes CLASS=\"IMAGE\" and IMAGE_VERSION=\"1.2\"";
-  std::cout << message << std::endl;
-}
-
-void parseAssumedValueStr(const std::string& assumedValueStr,
-                          std::vector<std::string>& comparisons,
-                          std::vector<std::string>& operators) {
-  std::string avs = assumedValueStr;
-  size_t pos;
-  while ((pos = std::min(avs.find("&&"), avs.find("||"))) != std::string::npos) {
-    const std::string comparison = avs.substr(0, pos);
-    if ( hasIntervalSigns(comparison) ) {
-      comparisons.push_back(comparison);
-    }
-    operators.push_back(avs.substr(pos,2));
-    avs.erase(0, pos + 2);
-  }
-  if ( hasIntervalSigns(avs) ) {
-    comparisons.push_back(avs);
-  }
-  if ( comparisons.size() != operators.size()+1 ) {
-    throw std::runtime_error("ERROR - assumed value string \"" + assumedValueStr +
-                             "\" not parsed correctly.");
-  }
-}
-
-void getArrayStatistics(const std::vector<double>& values, double& first, double& last,
-                        double& min, double& max, double& mean) {
-  first = values.front();
-  last = values.back();
-  min = std::numeric_limits<double>::max();
-  max = std::numeric_limits<double>::lowest();
-  mean = 0.0;
-  for (const double v : values) {
-    if ( v < min ) min = v;
-    if ( v > max ) max = v;
-    mean += v;
-  }
-  mean /= values.size();
-}
-
-double valueFromStatistics(std::string& comparison,
-                           double first, double last, double min, double max, double mean) {
-  size_t pos;
-  if ( (pos = comparison.find("first")) != std::string::npos ) {
-    comparison.erase(pos, 5);
-    return first;
-  }
-  else if ( (pos = comparison.find("last")) != std::string::npos ) {
-    comparison.erase(pos, 4);
-    return last;
-  }
-  else if ( (pos = comparison.find("min")) != std::string::npos ) {
-    comparison.erase(pos, 3);
-    return min;
-  }
-  else if ( (pos = comparison.find("max")) != std::string::npos ) {
-    comparison.erase(pos, 3);
-    return max;
-  }
-  else if ( (pos = comparison.find("mean")) != std::string::npos ) {
-    comparison.erase(pos, 4);
-    return mean;
-  }
-  else {
-    throw std::runtime_error("ERROR - proper statistics not found in the \"" +
-                             comparison + "\" comparison");
-  }
-}
-
-void splitPlusMinus(std::string pmString, double& center, double& interval) {
-  const std::string delimiter = "+-";
-  size_t pos = 0;
-  std::string centerStr;
-  if ((pos = pmString.find(delimiter)) != std::string::npos) {
-    centerStr = pmString.substr(0, pos);
-    center = std::stod(centerStr);
-    pmString.erase(0, pos + delimiter.length());
-    interval = std::stod(pmString);
-  }
-  else {
-    center = std::nan("");
-    interval = std::nan("");
-  }
+  out << message << std::endl;
 }
 
-bool entryFoundInDocTree(const std::vector<std::string>& parentsFound,
-                         const std::vector<std::string>& entriesFound) {
-  bool foundInDocTree = false;
-
-  if ( parentsFound.empty() || entriesFound.empty() ) {
-    return foundInDocTree;
-  }
-
-  int maxParentDepth = 0;
-  for (const auto& p : parentsFound) {
-    const int depth = std::count(p.begin(), p.end(), '/');
-    if ( depth > maxParentDepth ) maxParentDepth = depth;
-  }
-  //std::cout << "DBG - maxParentDepth = " << maxParentDepth << std::endl;
-
-  int parentStrSizeBefore = 0;
-  for (int depth = 0; depth < maxParentDepth; ++depth) {
-    int minParentStrSize = std::numeric_limits<int>::max();
-    for (const auto& parent : parentsFound) {
-      const int pSize = parent.length();
-      if ( pSize < minParentStrSize && pSize > parentStrSizeBefore ) {
-        minParentStrSize = pSize;
-      }
-    }
-    std::vector<std::string> baseParents;
-    for (const auto& parent : parentsFound) {
-      if ( (int)parent.length() == minParentStrSize ) {
-        baseParents.push_back(parent);
-      }
-    }
-    /*
-    std::cout << "DBG - baseParents : ";
-    for (const auto& p : baseParents) std::cout << p << ", ";
-    std::cout << std::endl;
-
-    std::cout << "DBG - entriesFound : ";
-    for (const auto& e : entriesFound) std::cout << e << ", ";
-    std::cout << std::endl;
-    */
-    foundInDocTree = allBaseParentsFoundInEntries(baseParents, entriesFound);
-    if ( foundInDocTree ) break;
-
-    parentStrSizeBefore = minParentStrSize;
-  }
-
-  return foundInDocTree;
-}
-
-bool allBaseParentsFoundInEntries(const std::vector<std::string>& baseParents,
-                                  const std::vector<std::string>& entriesFound) {
-  bool allFound = false;
-
-  if ( baseParents.empty() || entriesFound.empty() ) {
-    return allFound;
-  }
-
-  int foundNum = 0;
-  for (const auto& p : baseParents) {
-    if ( std::find(entriesFound.begin(), entriesFound.end(), p) != entriesFound.end() ) {
-      foundNum++;
-    }
-  }
-
-  allFound = (int)baseParents.size() == foundNum;
-  //std::cout << "DBG - baseParents.size() = " << baseParents.size() << ", foundNum = " << foundNum << ", allFound = " << allFound << std::endl;
-
-  return allFound;
+// true when all the parents at some depth of the tree have the entry - e.g. the how attributes
+// are either in the top level /how or in all the /dataset*/how groups
+bool entryFoundInDocTree(const H5PathTrie& paths, const std::vector<uint32_t>& parents,
+                         const std::vector<bool>& hasEntry) {
+  std::vector< std::pair<int, uint32_t> > byDepth;
+  byDepth.reserve(parents.size());
+  for (const uint32_t p : parents) {
+    int depth = 0;
+    for (uint32_t n = p; n != H5PathTrie::ROOT; n = paths.parent(n)) ++depth;
+    byDepth.emplace_back(depth, p);
+  }
+  std::sort(byDepth.begin(), byDepth.end());
+
+  size_t i = 0;
+  while ( i < byDepth.size() ) {
+    const int depth = byDepth[i].first;
+    bool allFound = true;
+    for ( ; i < byDepth.size() && byDepth[i].first == depth; ++i) {
+      if ( !hasEntry[byDepth[i].second] ) allFound = false;
+    }
+    if ( allFound ) return true;
+  }
+  return false;
 }
 
 } // end namespace myodim
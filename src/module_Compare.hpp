@@ -7,12 +7,25 @@
 #define MODULE_COMPARE_HPP
 
 #include <string>
+#include <regex>
 #include "class_H5Layout.hpp"
 #include "class_OdimStandard.hpp"
 
 namespace myodim {
 
+struct WhatSource {   // the identifiers of /what/source, empty when not present
+  std::string wmo{""};
+  std::string nod{""};
+  std::string rad{""};
+  std::string plc{""};
+  std::string org{""};
+  std::string cty{""};
+  std::string cmt{""};
+  std::string wigos{""};
+};
+
 extern bool printInfo;
+extern unsigned compareWorkers;   // threads checking the standard entries in compare, 1 by default
 
 extern std::string getCsvFileNameFrom(const myodim::H5Layout& h5layout);
 extern std::string getCsvFileNameFrom(const myodim::H5Layout& h5layout, std::string version);
@@ -23,12 +36,22 @@ extern bool isStringValue(const std::string& value);
 extern bool hasDoublePoint(const std::string& value);
 extern bool checkValue(const std::string& attrValue, const std::string& assumedValueStr,
                        std::string& errorMessage);
+extern bool checkValue(const std::string& attrValue, const std::regex& valueRegex,
+                       const std::string& assumedValueStr, std::string& errorMessage);
 extern bool checkValue(const double attrValue, const std::string& assumedValueStr,
                        std::string& errorMessage, const bool isReal=false);
 extern bool checkValue(const std::vector<double>& attrValues, const std::string& assumedValueStr,
                        std::string& errorMessage);
+extern bool checkValue(const double attrValue, const ValueExpression& assumedValue,
+                       std::string& errorMessage, const bool isReal=false);
+extern bool checkValue(const std::vector<double>& attrValues, const ValueExpression& assumedValue,
+                       std::string& errorMessage);
+extern bool checkValue(const std::vector<int64_t>& attrValues, const ValueExpression& assumedValue,
+                       std::string& errorMessage);
 extern bool checkWhatSource(const std::string& whatSource, const std::string& basicRegex,
                             std::string& errorMessage);
+extern bool parseWhatSource(const std::string& whatSource, WhatSource& parsed,
+                            std::string& errorMessage);
 
 
 }
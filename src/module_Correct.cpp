@@ -12,11 +12,15 @@
 #include <hdf5.h>
 #include "module_Correct.hpp"
 #include "class_H5Layout.hpp"
+#include "class_ValueExpression.hpp"
+#include "class_H5Handle.hpp"
+#include "module_FileAccess.hpp"
 
 namespace myodim {
 
 static void checkH5File_(const std::string& h5FilePath);
-static hid_t openH5File_(const std::string& h5FilePath, unsigned h5AccessFlag=H5F_ACC_RDONLY);
+static hid_t openH5File_(const std::string& h5FilePath, unsigned h5AccessFlag=H5F_ACC_RDONLY,
+                         const std::string& ioProfile="default");
 static void closeH5File_(const hid_t f);
 static void saveAsReal64Attribute_(hid_t f, const std::string attrName, const double attrValue);
 static void replaceAsReal64Attribute_(hid_t f, const H5Layout& source, const std::string attrName);
@@ -35,22 +39,13 @@ static double parseRealValue_(const std::string& valStr, const std::string attrN
 static std::vector<double> parseRealArrayValue_(std::string valStr, const std::string attrName);
 static int64_t parseIntValue_(const std::string& valStr, const std::string attrName);
 static std::vector<int64_t> parseIntArrayValue_(std::string valStr, const std::string attrName);
-static std::vector<OdimEntry> substituteWildcards_(const H5Layout& h5Layout, const OdimEntry& wildcardEntry);
+static std::vector<OdimEntry> substituteWildcards_(const H5Layout& h5Layout, const OdimEntry& wildcardEntry,
+                                                   const OdimRule& rule);
 static OdimStandard substituteWildcards_(const H5Layout& h5Layout, const OdimStandard& wildcardStandard);
-static bool hasWildcard_(const std::string& str);
-static void splitByWildcard_(const std::string& str, std::string& wildcardPart, std::string& noWildcardPart);
 static std::string getMatchingPart_(const std::string str, const std::regex& r);
 static void addIfUnique_(std::vector<OdimEntry>& list, const OdimEntry& e);
 static void addHowMetadataChanged_(hid_t f, const H5Layout& source, const std::vector<std::string>& metadataChanged);
-static bool hasIntervalSigns_(const std::string& assumedValueStr);
-static void parseAssumedValueStr_(const std::string& assumedValueStr,
-                                 std::vector<std::string>& comparisons,
-                                 std::vector<std::string>& operators);
-static void splitPlusMinus_(std::string pmString, double& center, double& interval);
-static void getSignAndNumberStr_(const std::string& compareStr,
-                                 std::string& signStr, std::string& numberStr, bool& hasPlusMinus);
-static void parseRealFromInterval_(const std::string& valStr, const std::string attrName, double& realVal);
-static void parseIntFromInterval_(const std::string& valStr, const std::string attrName, int64_t& intVal);
+static double centerOfInterval_(const ValueExpression& interval, const std::string attrName);
 
 void copyFile(const std::string& sourceFile, const std::string& copyFile) {
   FILE* fIn = fopen(sourceFile.c_str(), "rb");
@@ -77,13 +72,18 @@ void copyFile(const std::string& sourceFile, const std::string& copyFile) {
 }
 
 void correct(const std::string& sourceFile, const std::string& targetFile,
-             const OdimStandard& toCorrect) {
+             const OdimStandard& toCorrect, const bool useMmap,
+             const std::string& ioProfile) {
   checkH5File_(sourceFile);
   copyFile(sourceFile, targetFile);
-  H5Layout source(sourceFile);
+  H5Layout source;
+  source.setValuePrefetch(true);
+  source.setMmap(useMmap);
+  source.setIoProfile(ioProfile);
+  source.explore(sourceFile);
   OdimStandard toCorrectWithoutWildcards = substituteWildcards_(source, toCorrect);
   std::vector<std::string> metadataChanged;
-  auto f = openH5File_(targetFile, H5F_ACC_RDWR);
+  H5Handle f(openH5File_(targetFile, H5F_ACC_RDWR, ioProfile));   // closed also when a correction throws
   for (const auto& entry : toCorrectWithoutWildcards.entries) {
     if ( entry.category == OdimEntry::Category::Attribute ) {
 
@@ -202,7 +202,7 @@ void correct(const std::string& sourceFile, const std::string& targetFile,
 
   addHowMetadataChanged_(f, source, metadataChanged);
 
-  closeH5File_(f);
+  closeH5File_(f.release());
 }
 
 
@@ -214,8 +214,9 @@ void checkH5File_(const std::string& h5FilePath) {
   }
 }
 
-hid_t openH5File_(const std::string& h5FilePath, unsigned h5AccessFlag) {
-  hid_t f = H5Fopen(h5FilePath.c_str(), h5AccessFlag, H5P_DEFAULT);
+hid_t openH5File_(const std::string& h5FilePath, unsigned h5AccessFlag, const std::string& ioProfile) {
+  H5Handle fapl(createFileAccessPList(ioProfile, h5AccessFlag != H5F_ACC_RDONLY));
+  hid_t f = H5Fopen(h5FilePath.c_str(), h5AccessFlag, fapl);
   if ( f < 0 ) {
     throw std::runtime_error{"ERROR - file "+h5FilePath+" not opened"};
   }
@@ -230,58 +231,47 @@ void saveAsReal64Attribute_(hid_t f, const std::string attrName, const double at
   std::string path, name;
   splitAttributeToPathAndName_(attrName, path, name);
 
-  auto parent = H5Oopen(f, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
+  H5Handle parent(H5Oopen(f, path.c_str(), H5P_DEFAULT));
+  if ( !parent.isValid() ) {
     throw std::runtime_error("ERROR - node "+path+" not opened");
   }
 
   H5Adelete(parent, name.c_str());
 
-  hid_t sp = H5Screate(H5S_SCALAR);
-  auto a = H5Acreate2(parent, name.c_str(), H5T_NATIVE_DOUBLE, sp, H5P_DEFAULT, H5P_DEFAULT);
-  if ( a < 0 ) {
+  H5Handle sp(H5Screate(H5S_SCALAR));
+  H5Handle a(H5Acreate2(parent, name.c_str(), H5T_NATIVE_DOUBLE, sp, H5P_DEFAULT, H5P_DEFAULT));
+  if ( !a.isValid() ) {
     throw std::runtime_error("ERROR - attribute "+name+" not opened.");
   }
 
   auto ret  = H5Awrite(a, H5T_NATIVE_DOUBLE, &attrValue);
   if ( ret < 0  ) {
-    H5Aclose(a);
-    H5Oclose(parent);
     throw std::runtime_error("ERROR - attribute "+attrName+" not written");
   }
-  H5Sclose(sp);
-  H5Aclose(a);
-  H5Oclose(parent);
 }
 
 void saveAsReal64ArrayAttribute_(hid_t f, const std::string attrName, const std::vector<double>& attrValue) {
   std::string path, name;
   splitAttributeToPathAndName_(attrName, path, name);
 
-  auto parent = H5Oopen(f, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
+  H5Handle parent(H5Oopen(f, path.c_str(), H5P_DEFAULT));
+  if ( !parent.isValid() ) {
     throw std::runtime_error("ERROR - node "+path+" not opened");
   }
 
   H5Adelete(parent, name.c_str());
 
   const hsize_t dims[1] = {attrValue.size()};
-  hid_t sp = H5Screate_simple (1, dims, NULL);
-  auto a = H5Acreate2(parent, name.c_str(), H5T_NATIVE_DOUBLE, sp, H5P_DEFAULT, H5P_DEFAULT);
-  if ( a < 0 ) {
+  H5Handle sp(H5Screate_simple (1, dims, NULL));
+  H5Handle a(H5Acreate2(parent, name.c_str(), H5T_NATIVE_DOUBLE, sp, H5P_DEFAULT, H5P_DEFAULT));
+  if ( !a.isValid() ) {
     throw std::runtime_error("ERROR - attribute "+name+" not opened.");
   }
 
   auto ret  = H5Awrite(a, H5T_NATIVE_DOUBLE, attrValue.data());
   if ( ret < 0  ) {
-    H5Aclose(a);
-    H5Oclose(parent);
     throw std::runtime_error("ERROR - attribute "+attrName+" not written");
   }
-
-  H5Sclose(sp);
-  H5Aclose(a);
-  H5Oclose(parent);
 }
 
 void replaceAsReal64Attribute_(hid_t f, const H5Layout& source, const std::string attrName) {
@@ -300,58 +290,47 @@ void saveAsInt64Attribute_(hid_t f, const std::string attrName, const int64_t at
   std::string path, name;
   splitAttributeToPathAndName_(attrName, path, name);
 
-  auto parent = H5Oopen(f, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
+  H5Handle parent(H5Oopen(f, path.c_str(), H5P_DEFAULT));
+  if ( !parent.isValid() ) {
     throw std::runtime_error("ERROR - node "+path+" not opened");
   }
 
   H5Adelete(parent, name.c_str());
 
-  hid_t sp = H5Screate(H5S_SCALAR);
-  auto a = H5Acreate2(parent, name.c_str(), H5T_NATIVE_INT64, sp, H5P_DEFAULT, H5P_DEFAULT);
-  if ( a < 0 ) {
+  H5Handle sp(H5Screate(H5S_SCALAR));
+  H5Handle a(H5Acreate2(parent, name.c_str(), H5T_NATIVE_INT64, sp, H5P_DEFAULT, H5P_DEFAULT));
+  if ( !a.isValid() ) {
     throw std::runtime_error("ERROR - attribute "+name+" not opened.");
   }
 
   auto ret  = H5Awrite(a, H5T_NATIVE_INT64, &attrValue);
   if ( ret < 0  ) {
-    H5Aclose(a);
-    H5Oclose(parent);
     throw std::runtime_error("ERROR - attribute "+attrName+" not written");
   }
-
-  H5Sclose(sp);
-  H5Aclose(a);
-  H5Oclose(parent);
 }
 
 void saveAsInt64ArrayAttribute_(hid_t f, const std::string attrName, const std::vector<int64_t>& attrValue) {
   std::string path, name;
   splitAttributeToPathAndName_(attrName, path, name);
 
-  auto parent = H5Oopen(f, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
+  H5Handle parent(H5Oopen(f, path.c_str(), H5P_DEFAULT));
+  if ( !parent.isValid() ) {
     throw std::runtime_error("ERROR - node "+path+" not opened");
   }
 
   H5Adelete(parent, name.c_str());
 
   const hsize_t dims[1] = {attrValue.size()};
-  hid_t sp = H5Screate_simple (1, dims, NULL);
-  auto a = H5Acreate2(parent, name.c_str(), H5T_NATIVE_INT64, sp, H5P_DEFAULT, H5P_DEFAULT);
-  if ( a < 0 ) {
+  H5Handle sp(H5Screate_simple (1, dims, NULL));
+  H5Handle a(H5Acreate2(parent, name.c_str(), H5T_NATIVE_INT64, sp, H5P_DEFAULT, H5P_DEFAULT));
+  if ( !a.isValid() ) {
     throw std::runtime_error("ERROR - attribute "+name+" not opened.");
   }
 
   auto ret  = H5Awrite(a, H5T_NATIVE_INT64, attrValue.data());
   if ( ret < 0  ) {
-    H5Aclose(a);
-    H5Oclose(parent);
     throw std::runtime_error("ERROR - attribute "+attrName+" not written");
   }
-  H5Sclose(sp);
-  H5Aclose(a);
-  H5Oclose(parent);
 }
 
 
@@ -371,38 +350,26 @@ void saveAsFixedLengthStringAttribute_(hid_t f, const std::string attrName, cons
   std::string path, name;
   splitAttributeToPathAndName_(attrName, path, name);
 
-  auto parent = H5Oopen(f, path.c_str(), H5P_DEFAULT);
-  if ( parent < 0  ) {
+  H5Handle parent(H5Oopen(f, path.c_str(), H5P_DEFAULT));
+  if ( !parent.isValid() ) {
     throw std::runtime_error("ERROR - node "+path+" not opened");
   }
 
   H5Adelete(parent, name.c_str());
 
-  auto sp  = H5Screate(H5S_SCALAR);
-  auto t = H5Tcopy(H5T_C_S1);
+  H5Handle sp(H5Screate(H5S_SCALAR));
+  H5Handle t(H5Tcopy(H5T_C_S1));
   H5Tset_size(t, attrValue.length()+1);
   H5Tset_strpad(t, H5T_STR_NULLTERM);
-  auto a = H5Acreate2(parent, name.c_str(), t, sp, H5P_DEFAULT, H5P_DEFAULT);
-  if ( a < 0 ) {
-    H5Sclose(sp);
-    H5Tclose(t);
-    H5Oclose(parent);
+  H5Handle a(H5Acreate2(parent, name.c_str(), t, sp, H5P_DEFAULT, H5P_DEFAULT));
+  if ( !a.isValid() ) {
     throw std::runtime_error("ERROR - attribute "+name+" not opened.");
   }
 
   auto ret  = H5Awrite(a, t, attrValue.c_str());
   if ( ret < 0  ) {
-    H5Sclose(sp);
-    H5Tclose(t);
-    H5Aclose(a);
-    H5Oclose(parent);
     throw std::runtime_error("ERROR - attribute "+attrName+" not written");
   }
-
-  H5Sclose(sp);
-  H5Tclose(t);
-  H5Aclose(a);
-  H5Oclose(parent);
 }
 
 void replaceAsFixedLengthStringAttribute_(hid_t f, const H5Layout& source, const std::string attrName) {
@@ -412,15 +379,13 @@ void replaceAsFixedLengthStringAttribute_(hid_t f, const H5Layout& source, const
 }
 
 void addGroup_(hid_t f, const std::string& name) {
-  auto g = H5Oopen(f, name.c_str(), H5P_DEFAULT);
-  if ( g < 0 ) {
-    g = H5Gcreate(f, name.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-    if ( g < 0 ) {
+  H5Handle g(H5Oopen(f, name.c_str(), H5P_DEFAULT));
+  if ( !g.isValid() ) {
+    g.reset(H5Gcreate(f, name.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT));
+    if ( !g.isValid() ) {
       throw std::runtime_error("ERROR - group "+name+" not created");
     }
   }
-  H5Oclose(g);
-  return;
 }
 
 void splitAttributeToPathAndName_(const std::string& attrName,
@@ -432,8 +397,9 @@ void splitAttributeToPathAndName_(const std::string& attrName,
 
 double parseRealValue_(const std::string& valStr, const std::string attrName) {
   double d = std::nan("");
-  if ( hasIntervalSigns_(valStr) ) {
-    parseRealFromInterval_(valStr, attrName, d);
+  const ValueExpression expression{valStr};
+  if ( expression.isInterval() ) {
+    d = centerOfInterval_(expression, attrName);
   }
   else {
     try {
@@ -467,8 +433,9 @@ std::vector<double> parseRealArrayValue_(std::string valStr, const std::string a
 
 int64_t parseIntValue_(const std::string& valStr, const std::string attrName) {
   int64_t i;
-  if ( hasIntervalSigns_(valStr) ) {
-    parseIntFromInterval_(valStr, attrName, i);
+  const ValueExpression expression{valStr};
+  if ( expression.isInterval() ) {
+    i = centerOfInterval_(expression, attrName);
   }
   else {
     try {
@@ -499,45 +466,40 @@ std::vector<int64_t> parseIntArrayValue_(std::string valStr, const std::string a
   return result;
 }
 
-std::vector<OdimEntry> substituteWildcards_(const H5Layout& h5Layout, const OdimEntry& wildcardEntry) {
+std::vector<OdimEntry> substituteWildcards_(const H5Layout& h5Layout, const OdimEntry& wildcardEntry,
+                                            const OdimRule& rule) {
   std::vector<OdimEntry> resultEntries;
 
-  if ( hasWildcard_(wildcardEntry.node) ) {
-    std::string wc, other;
-    splitByWildcard_(wildcardEntry.node, wc, other);
-    std::regex wildcardRegex{wc};
+  if ( rule.hasWildcard ) {
+    if ( !rule.hasWildcardRegex ) {
+      throw std::runtime_error{"ERROR - wildcards of the node "+wildcardEntry.node+" can not be substituted"};
+    }
+    const std::string& other = rule.wildcardRest;
+    const std::regex& wildcardRegex = rule.wildcardRegex;
 
+    // only the paths with the literal prefix and suffix of the pattern go to the regex
+    std::vector<size_t> candidates;
+    const std::vector<h5Entry>* objects = &h5Layout.datasets;
     if ( wildcardEntry.category == OdimEntry::Category::Group ) {
-      for (const auto& g : h5Layout.groups) {
-        if ( std::regex_match(g.name(), wildcardRegex)  ) {
-          OdimEntry e = wildcardEntry;
-          std::string matchingPart = getMatchingPart_(g.name(), wildcardRegex);
-          if ( matchingPart.empty() ) continue;
-          e.node = matchingPart+other;
-          addIfUnique_(resultEntries, e);
-        }
-      }
+      h5Layout.candidateGroups(rule.wildcardPattern, candidates);
+      objects = &h5Layout.groups;
     }
     else if ( wildcardEntry.category == OdimEntry::Category::Attribute ) {
-      for (const auto& a : h5Layout.attributes) {
-        if ( std::regex_match(a.name(), wildcardRegex)  ) {
-          OdimEntry e = wildcardEntry;
-          std::string matchingPart = getMatchingPart_(a.name(), wildcardRegex);
-          if ( matchingPart.empty() ) continue;
-          e.node = matchingPart+other;
-          addIfUnique_(resultEntries, e);
-        }
-      }
+      h5Layout.candidateAttributes(rule.wildcardPattern, candidates);
+      objects = &h5Layout.attributes;
     }
     else {
-      for (const auto& d : h5Layout.datasets) {
-        if ( std::regex_match(d.name(), wildcardRegex)  ) {
-          OdimEntry e = wildcardEntry;
-          std::string matchingPart = getMatchingPart_(d.name(), wildcardRegex);
-          if ( matchingPart.empty() ) continue;
-          e.node = matchingPart+other;
-          addIfUnique_(resultEntries, e);
-        }
+      h5Layout.candidateDatasets(rule.wildcardPattern, candidates);
+    }
+
+    for (const size_t i : candidates) {
+      const std::string name = (*objects)[i].name();
+      if ( std::regex_match(name, wildcardRegex)  ) {
+        OdimEntry e = wildcardEntry;
+        std::string matchingPart = getMatchingPart_(name, wildcardRegex);
+        if ( matchingPart.empty() ) continue;
+        e.node = matchingPart+other;
+        addIfUnique_(resultEntries, e);
       }
     }
   }
@@ -550,8 +512,9 @@ std::vector<OdimEntry> substituteWildcards_(const H5Layout& h5Layout, const Odim
 
 OdimStandard substituteWildcards_(const H5Layout& h5Layout, const OdimStandard& wildcardStandard) {
   OdimStandard result;
-  for (const auto& e : wildcardStandard.entries) {
-    std::vector<OdimEntry> entries = substituteWildcards_(h5Layout, e);
+  const std::vector<OdimRule>& rules = wildcardStandard.rules();
+  for (size_t i=0; i<wildcardStandard.entries.size(); ++i) {
+    std::vector<OdimEntry> entries = substituteWildcards_(h5Layout, wildcardStandard.entries[i], rules[i]);
     for (const auto& ee : entries) {
       result.entries.push_back(ee);
     }
@@ -559,34 +522,6 @@ OdimStandard substituteWildcards_(const H5Layout& h5Layout, const OdimStandard&
   return result;
 }
 
-bool hasWildcard_(const std::string& str) {
-  return str.find('*') != std::string::npos ||
-         str.find('[') != std::string::npos ||
-         str.find('?') != std::string::npos ;
-}
-
-void splitByWildcard_(const std::string& str, std::string& wildcardPart, std::string& noWildcardPart) {
-  if ( !hasWildcard_(str) ) {
-    wildcardPart = str;
-    noWildcardPart = "";
-    return;
-  }
-
-  std::vector<size_t> tmp = {str.find_last_of("*"),
-                             str.find_last_of("["),
-                             str.find_last_of("]"),
-                             str.find_last_of("?")};
-
-  size_t lastWCPosi = 0;
-  for (int i=0; i<4; ++i) {
-    if ( tmp[i] == std::string::npos ) continue;
-    if ( tmp[i] > lastWCPosi ) lastWCPosi = tmp[i];
-  }
-  std::string wrkStr = str.substr(lastWCPosi);
-  auto p = wrkStr.find("/");
-  wildcardPart = str.substr(0,lastWCPosi+p);
-  noWildcardPart = str.substr(lastWCPosi+p);
-}
 
 std::string getMatchingPart_(const std::string str, const std::regex& r) {
   std::string tmp = "";
@@ -633,149 +568,31 @@ void addHowMetadataChanged_(hid_t f, const H5Layout& source,
   saveAsFixedLengthStringAttribute_(f, "/how/metadata_changed", value);
 }
 
-bool hasIntervalSigns_(const std::string& assumedValueStr) {
-  return assumedValueStr.find('=') != std::string::npos ||
-         assumedValueStr.find('<') != std::string::npos ||
-         assumedValueStr.find('>') != std::string::npos ||
-         assumedValueStr.find("+-") != std::string::npos;
-}
-
-void parseAssumedValueStr_(const std::string& assumedValueStr,
-                          std::vector<std::string>& comparisons,
-                          std::vector<std::string>& operators) {
-  std::string avs = assumedValueStr;
-  size_t pos;
-  while ((pos = std::min(avs.find("&&"), avs.find("||"))) != std::string::npos) {
-    const std::string comparison = avs.substr(0, pos);
-    if ( hasIntervalSigns_(comparison) ) {
-      comparisons.push_back(comparison);
+// the value of a closed interval, e.g. 5.0 for 4.9+-0.2 or >=0&&<10
+double centerOfInterval_(const ValueExpression& interval, const std::string attrName) {
+  interval.rethrowError();
+  const auto& terms = interval.terms();
+  const std::string& valStr = interval.source();
+  if ( terms.size() == 1 ) {
+    if ( terms[0].comparison == ValueExpression::Within ) {
+      return terms[0].number;
     }
-    operators.push_back(avs.substr(pos,2));
-    avs.erase(0, pos + 2);
-  }
-  if ( hasIntervalSigns_(avs) ) {
-    comparisons.push_back(avs);
-  }
-  if ( comparisons.size() != operators.size()+1 ) {
-    throw std::runtime_error("ERROR - assumed value string \"" + assumedValueStr +
-                             "\" not parsed correctly.");
-  }
-}
-
-void splitPlusMinus_(std::string pmString, double& center, double& interval) {
-  const std::string delimiter = "+-";
-  size_t pos = 0;
-  std::string centerStr;
-  if ((pos = pmString.find(delimiter)) != std::string::npos) {
-    centerStr = pmString.substr(0, pos);
-    center = std::stod(centerStr);
-    pmString.erase(0, pos + delimiter.length());
-    interval = std::stod(pmString);
+    throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly - it is an open interval");
   }
-  else {
-    center = std::nan("");
-    interval = std::nan("");
-  }
-}
-
-void getSignAndNumberStr_(const std::string& compareStr, std::string& signStr, std::string& numberStr,
-                          bool& hasPlusMinus) {
-  hasPlusMinus = false;
-  for (int i=0; i<(int)compareStr.length(); ++i) {
-    if ( (compareStr[i] >= '0' && compareStr[i] <= '9') || compareStr[i] <= '.' ) {
-      numberStr.append(1, compareStr[i]);
-      if ( compareStr[i] == '-' && i > 0 && compareStr[i-1] == '+') {
-        hasPlusMinus = true;
-      }
-    }
-    else {
-      signStr.append(1, compareStr[i]);
-    }
-  }
-}
-
-void parseRealFromInterval_(const std::string& valStr, const std::string attrName, double& realVal) {
-  realVal = std::nan("");
-  std::vector<std::string> comparisons;
-  std::vector<std::string> operators;
-  parseAssumedValueStr_(valStr, comparisons, operators);
-  if ( comparisons.size() == 1 ) {
-    std::string signStr, numberStr;
-    bool hasPlusMinus = false;
-    getSignAndNumberStr_(comparisons[0], signStr, numberStr, hasPlusMinus);
-    if ( hasPlusMinus ) {
-      double center, interval;
-      splitPlusMinus_(numberStr, center, interval);
-      realVal = center;
-    }
-    else {
-      throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly - it is an open interval");
-    }
-  }
-  else if ( comparisons.size() == 2 ) {
-    if ( operators[0] != "&&" ) {
-      throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly ");
-    }
-    std::vector<std::string> signStr(2), numberStr(2);
-    bool hasPlusMinus[2];
-    for (int i=0; i<2; ++i) {
-      getSignAndNumberStr_(comparisons[i], signStr[i], numberStr[i], hasPlusMinus[i]);
-    }
-    if ( (signStr[0].find('<') != std::string::npos && signStr[1].find('>') != std::string::npos) ||
-         (signStr[0].find('>') != std::string::npos && signStr[1].find('<') != std::string::npos) ) {
-      double d1 = numberStr[0].empty() ? std::nan("") : std::stod(numberStr[0]);
-      double d2 = numberStr[1].empty() ? std::nan("") : std::stod(numberStr[1]);
-      realVal = (d1 + d2) / 2;
-    }
-    else {
-      throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly - it is an open interval");
-    }
-  }
-  else {
-    throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly ");
-  }
-}
-
-void parseIntFromInterval_(const std::string& valStr, const std::string attrName, int64_t& intVal) {
-  intVal = 0;
-  std::vector<std::string> comparisons;
-  std::vector<std::string> operators;
-  parseAssumedValueStr_(valStr, comparisons, operators);
-  if ( comparisons.size() == 1 ) {
-    std::string signStr, numberStr;
-    bool hasPlusMinus = false;
-    getSignAndNumberStr_(comparisons[0], signStr, numberStr, hasPlusMinus);
-    if ( hasPlusMinus ) {
-      double center, interval;
-      splitPlusMinus_(numberStr, center, interval);
-      intVal = center;
-    }
-    else {
-      throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly - it is an open interval");
-    }
-  }
-  else if ( comparisons.size() == 2 ) {
-    if ( operators[0] != "&&" ) {
+  else if ( terms.size() == 2 ) {
+    if ( interval.operators()[0] != ValueExpression::And ) {
       throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly ");
     }
-    std::vector<std::string> signStr(2), numberStr(2);
-    bool hasPlusMinus[2];
-    for (int i=0; i<2; ++i) {
-      getSignAndNumberStr_(comparisons[i], signStr[i], numberStr[i], hasPlusMinus[i]);
+    const bool isUpper[2] = {terms[0].comparison == ValueExpression::Less || terms[0].comparison == ValueExpression::LessEqual,
+                             terms[1].comparison == ValueExpression::Less || terms[1].comparison == ValueExpression::LessEqual};
+    const bool isLower[2] = {terms[0].comparison == ValueExpression::Greater || terms[0].comparison == ValueExpression::GreaterEqual,
+                             terms[1].comparison == ValueExpression::Greater || terms[1].comparison == ValueExpression::GreaterEqual};
+    if ( (isUpper[0] && isLower[1]) || (isLower[0] && isUpper[1]) ) {
+      return (terms[0].number + terms[1].number) / 2.0;
     }
-    if ( (signStr[0].find('<') != std::string::npos && signStr[1].find('>') != std::string::npos) ||
-         (signStr[0].find('>') != std::string::npos && signStr[1].find('<') != std::string::npos) ) {
-      double d1 = numberStr[0].empty() ? std::nan("") : std::stod(numberStr[0]);
-      double d2 = numberStr[1].empty() ? std::nan("") : std::stod(numberStr[1]);
-      intVal = (d1 + d2) / 2.0;
-    }
-    else {
-      throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly - it is an open interval");
-    }
-  }
-  else {
-    throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly ");
+    throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly - it is an open interval");
   }
+  throw std::invalid_argument("ERROR - the value of "+attrName+" - defined as "+valStr+" - not parsed correctly ");
 }
 
 } //end namespace myodim
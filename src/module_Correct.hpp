@@ -13,7 +13,8 @@ namespace myodim {
 
 extern void copyFile(const std::string& sourceFile, const std::string& copyFile);
 extern void correct(const std::string& sourceFile, const std::string& targetFile,
-                     const OdimStandard& toCorrect);
+                     const OdimStandard& toCorrect, const bool useMmap=false,     // useMmap - read the source through mmap
+                     const std::string& ioProfile="default");                     // see module_FileAccess
 
 } // end myodim
 
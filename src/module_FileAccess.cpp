@@ -0,0 +1,61 @@
+// module_FileAccess.cpp
+// tuned HDF5 file-access property profiles and the I/O statistics
+// Ladislav Meri, SHMU
+
+#include "module_FileAccess.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace myodim {
+
+bool isIoProfile(const std::string& ioProfile) {
+  return ioProfile == "default" || ioProfile == "network-fs";
+}
+
+hid_t createFileAccessPList(const std::string& ioProfile, const bool forWriting) {
+  if ( !isIoProfile(ioProfile) ) {
+    throw std::runtime_error{"ERROR - unknown io profile "+ioProfile+
+                             " - possible values: default, network-fs"};
+  }
+  hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+  if ( fapl < 0 ) {
+    throw std::runtime_error{"ERROR - file access property list not created"};
+  }
+  bool ok = true;
+  if ( ioProfile == "network-fs" ) {
+    // every request is a round trip - load the whole file by one sequential read with the core driver
+    ok = H5Pset_fapl_core(fapl, 1024*1024, forWriting ? 1 : 0) >= 0;
+  }
+  if ( !ok ) {
+    H5Pclose(fapl);
+    throw std::runtime_error{"ERROR - file access property list for io profile "+ioProfile+" not set"};
+  }
+  return fapl;
+}
+
+IoCounts currentIoCounts() {
+  IoCounts counts;
+  std::ifstream io("/proc/self/io");
+  std::string key;
+  uint64_t value;
+  while ( io >> key >> value ) {
+    if ( key == "syscr:" ) counts.readCalls = value;
+    else if ( key == "rchar:" ) counts.readBytes = value;
+  }
+  return counts;
+}
+
+std::string ioReport(const std::string& ioProfile, const IoCounts& start, const double mdcHitRate) {
+  const IoCounts now = currentIoCounts();
+  std::ostringstream report;
+  report << "INFO - io profile " << ioProfile << " - " << now.readCalls-start.readCalls << " read calls, " <<
+            now.readBytes-start.readBytes << " bytes read";
+  if ( mdcHitRate >= 0.0 ) {
+    report << ", metadata cache hit rate " << mdcHitRate;
+  }
+  return report.str();
+}
+
+} // end myodim
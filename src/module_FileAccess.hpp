@@ -0,0 +1,28 @@
+// module_FileAccess.hpp
+// tuned HDF5 file-access property profiles and the I/O statistics
+// Ladislav Meri, SHMU
+
+#ifndef MODULE_FILEACCESS_HPP
+#define MODULE_FILEACCESS_HPP
+
+#include <string>
+#include <stdint.h>
+#include <hdf5.h>
+
+namespace myodim {
+
+struct IoCounts {    // from /proc/self/io, all zero where not available
+  uint64_t readCalls{0};
+  uint64_t readBytes{0};
+};
+
+// the known profiles are "default" and "network-fs", throws on other names
+// the returned property list is to be closed by H5Pclose
+extern hid_t createFileAccessPList(const std::string& ioProfile, const bool forWriting=false);
+extern bool isIoProfile(const std::string& ioProfile);
+extern IoCounts currentIoCounts();
+extern std::string ioReport(const std::string& ioProfile, const IoCounts& start, const double mdcHitRate);
+
+} // end myodim
+
+#endif // MODULE_FILEACCESS_HPP
@@ -0,0 +1,156 @@
+// module_Statistics.cpp
+// statistics of the array attribute values - vectorized with AVX2 or SSE2 when compiled so, scalar otherwise
+// Ladislav Meri, SHMU
+
+#include "module_Statistics.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace myodim {
+
+static double minOf(const double* values, const size_t count);
+static double maxOf(const double* values, const size_t count);
+static double sumOf(const double* values, const size_t count);
+static int64_t minOf(const int64_t* values, const size_t count);
+static int64_t maxOf(const int64_t* values, const size_t count);
+static double sumOf(const int64_t* values, const size_t count);
+
+template <typename T>
+void arrayStatistics(const T* values, const size_t count, const unsigned needed,
+                     ArrayStatistics<T>& statistics) {
+  if ( count == 0 ) return;
+  statistics.first = values[0];
+  statistics.last = values[count-1];
+  if ( needed & NEED_MIN ) statistics.min = minOf(values, count);
+  if ( needed & NEED_MAX ) statistics.max = maxOf(values, count);
+  if ( needed & NEED_MEAN ) statistics.mean = sumOf(values, count) / count;
+}
+
+template void arrayStatistics<double>(const double* values, const size_t count, const unsigned needed,
+                                      ArrayStatistics<double>& statistics);
+template void arrayStatistics<int64_t>(const int64_t* values, const size_t count, const unsigned needed,
+                                       ArrayStatistics<int64_t>& statistics);
+
+// the NaN values are skipped as by the scalar comparison - the vector min/max return their second operand then
+double minOf(const double* values, const size_t count) {
+  double result = std::numeric_limits<double>::max();
+  size_t i = 0;
+#if defined(__AVX2__)
+  if ( count >= 4 ) {
+    __m256d acc = _mm256_set1_pd(result);
+    for (; i+4<=count; i+=4) acc = _mm256_min_pd(_mm256_loadu_pd(values+i), acc);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    for (const double v : lanes) if ( v < result ) result = v;
+  }
+#elif defined(__SSE2__)
+  if ( count >= 2 ) {
+    __m128d acc = _mm_set1_pd(result);
+    for (; i+2<=count; i+=2) acc = _mm_min_pd(_mm_loadu_pd(values+i), acc);
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    for (const double v : lanes) if ( v < result ) result = v;
+  }
+#endif
+  for (; i<count; ++i) if ( values[i] < result ) result = values[i];
+  return result;
+}
+
+double maxOf(const double* values, const size_t count) {
+  double result = std::numeric_limits<double>::lowest();
+  size_t i = 0;
+#if defined(__AVX2__)
+  if ( count >= 4 ) {
+    __m256d acc = _mm256_set1_pd(result);
+    for (; i+4<=count; i+=4) acc = _mm256_max_pd(_mm256_loadu_pd(values+i), acc);
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    for (const double v : lanes) if ( v > result ) result = v;
+  }
+#elif defined(__SSE2__)
+  if ( count >= 2 ) {
+    __m128d acc = _mm_set1_pd(result);
+    for (; i+2<=count; i+=2) acc = _mm_max_pd(_mm_loadu_pd(values+i), acc);
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    for (const double v : lanes) if ( v > result ) result = v;
+  }
+#endif
+  for (; i<count; ++i) if ( values[i] > result ) result = values[i];
+  return result;
+}
+
+double sumOf(const double* values, const size_t count) {
+  double result = 0.0;
+  size_t i = 0;
+#if defined(__AVX2__)
+  if ( count >= 4 ) {
+    __m256d acc = _mm256_setzero_pd();
+    for (; i+4<=count; i+=4) acc = _mm256_add_pd(acc, _mm256_loadu_pd(values+i));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  }
+#elif defined(__SSE2__)
+  if ( count >= 2 ) {
+    __m128d acc = _mm_setzero_pd();
+    for (; i+2<=count; i+=2) acc = _mm_add_pd(acc, _mm_loadu_pd(values+i));
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    result = lanes[0] + lanes[1];
+  }
+#endif
+  for (; i<count; ++i) result += values[i];
+  return result;
+}
+
+// SSE2 has no 64-bit integer comparison, only the AVX2 path is vectorized
+int64_t minOf(const int64_t* values, const size_t count) {
+  int64_t result = std::numeric_limits<int64_t>::max();
+  size_t i = 0;
+#if defined(__AVX2__)
+  if ( count >= 4 ) {
+    __m256i acc = _mm256_set1_epi64x(result);
+    for (; i+4<=count; i+=4) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values+i));
+      acc = _mm256_blendv_epi8(acc, v, _mm256_cmpgt_epi64(acc, v));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    for (const int64_t v : lanes) if ( v < result ) result = v;
+  }
+#endif
+  for (; i<count; ++i) if ( values[i] < result ) result = values[i];
+  return result;
+}
+
+int64_t maxOf(const int64_t* values, const size_t count) {
+  int64_t result = std::numeric_limits<int64_t>::lowest();
+  size_t i = 0;
+#if defined(__AVX2__)
+  if ( count >= 4 ) {
+    __m256i acc = _mm256_set1_epi64x(result);
+    for (; i+4<=count; i+=4) {
+      const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values+i));
+      acc = _mm256_blendv_epi8(acc, v, _mm256_cmpgt_epi64(v, acc));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    for (const int64_t v : lanes) if ( v > result ) result = v;
+  }
+#endif
+  for (; i<count; ++i) if ( values[i] > result ) result = values[i];
+  return result;
+}
+
+// summed in double as the values converted to double always were - an int64_t sum overflows for large values
+// and AVX2 has no int64 to double conversion, so this one stays scalar
+double sumOf(const int64_t* values, const size_t count) {
+  double result = 0.0;
+  for (size_t i=0; i<count; ++i) result += static_cast<double>(values[i]);
+  return result;
+}
+
+} // end namespace myodim
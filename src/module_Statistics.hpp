@@ -0,0 +1,33 @@
+// module_Statistics.hpp
+// statistics of the array attribute values - vectorized with AVX2 or SSE2 when compiled so, scalar otherwise
+// Ladislav Meri, SHMU
+
+#ifndef MODULE_STATISTICS_HPP
+#define MODULE_STATISTICS_HPP
+
+#include <cstddef>
+#include <cmath>
+#include <limits>
+#include <stdint.h>
+
+namespace myodim {
+
+enum StatisticsNeeded { NEED_MIN = 1, NEED_MAX = 2, NEED_MEAN = 4, NEED_ALL = 7 };   // first and last always
+
+template <typename T>
+struct ArrayStatistics {
+  T first{0};
+  T last{0};
+  T min{std::numeric_limits<T>::max()};
+  T max{std::numeric_limits<T>::lowest()};
+  double mean{std::nan("")};
+};
+
+// defined for double and int64_t, the statistics not needed keep their initial values
+template <typename T>
+extern void arrayStatistics(const T* values, const size_t count, const unsigned needed,
+                            ArrayStatistics<T>& statistics);
+
+} // end namespace myodim
+
+#endif // MODULE_STATISTICS_HPP
@@ -4,6 +4,7 @@
 #include "cxxopts.hpp"
 #include "class_H5Layout.hpp"
 #include "module_Compare.hpp"
+#include "module_FileAccess.hpp"
 
 int main(int argc, const char* argv[]) {
 
@@ -18,7 +19,10 @@ int main(int argc, const char* argv[]) {
     ("t,type", "specify the type of te attribute - possible values: string, int, real",
      cxxopts::value<std::string>())
     ("noInfo", "don`t print INFO messages, only WARNINGs and ERRORs, default is False",
-     cxxopts::value<bool>()->default_value("false"));
+     cxxopts::value<bool>()->default_value("false"))
+    ("io-profile", "HDF5 file access profile - possible values: default, network-fs, "
+                   "the achieved I/O counts are reported at the end, default is default",
+        cxxopts::value<std::string>()->default_value("default"));
 
   auto cmdLineOptions = options.parse(argc, argv);
   if ( cmdLineOptions.count("input") != 1 ||
@@ -33,9 +37,14 @@ int main(int argc, const char* argv[]) {
 
   const std::string h5File = cmdLineOptions["input"].as<std::string>();
 
-  myodim::H5Layout h5layout(h5File);
-
+  const std::string ioProfile{cmdLineOptions["io-profile"].as<std::string>()};
+  const bool reportIo{cmdLineOptions.count("io-profile") > 0 && myodim::printInfo};
+  const myodim::IoCounts ioStart = myodim::currentIoCounts();
   const std::string attrName = cmdLineOptions["attribute"].as<std::string>();
+  myodim::H5Layout h5layout;
+  h5layout.setIoProfile(ioProfile);
+  h5layout.explore(h5File, {attrName});   // only the subtree of the attribute is needed
+
   const std::string strAssumedValue = cmdLineOptions["value"].as<std::string>();
   std::string strAssumedType = cmdLineOptions.count("type") > 0 ?
                                cmdLineOptions["type"].as<std::string>() :
@@ -126,6 +135,9 @@ int main(int argc, const char* argv[]) {
   catch (const std::exception& e) {
     std::cout << e.what() << std::endl;
   }
+  if ( reportIo ) {
+    std::cout << myodim::ioReport(ioProfile, ioStart, h5layout.metadataCacheHitRate()) << std::endl;
+  }
 
 
   if ( valueIsOK ) {
@@ -5,6 +5,7 @@
 #include "class_OdimStandard.hpp"
 #include "module_Compare.hpp"
 #include "module_Correct.hpp"
+#include "module_FileAccess.hpp"
 
 int main(int argc, const char* argv[]) {
 
@@ -18,7 +19,12 @@ int main(int argc, const char* argv[]) {
   options.add_options("Optional")
     ("h,help", "print this help message")
     ("noInfo", "don`t print INFO messages, only WARNINGs and ERRORs, default is False",
-        cxxopts::value<bool>()->default_value("false"));
+        cxxopts::value<bool>()->default_value("false"))
+    ("mmap", "read the input file through mmap instead of the default HDF5 file driver, default is False",
+        cxxopts::value<bool>()->default_value("false"))
+    ("io-profile", "HDF5 file access profile - possible values: default, network-fs, "
+                   "the achieved I/O counts are reported at the end, default is default",
+        cxxopts::value<std::string>()->default_value("default"));
 
 
   auto cmdLineOptions = options.parse(argc, argv);
@@ -38,7 +44,12 @@ int main(int argc, const char* argv[]) {
 
   const myodim::OdimStandard toCorrect(csvFile);
 
-  myodim::correct(inH5File, outH5File, toCorrect);
+  const std::string ioProfile{cmdLineOptions["io-profile"].as<std::string>()};
+  const myodim::IoCounts ioStart = myodim::currentIoCounts();
+  myodim::correct(inH5File, outH5File, toCorrect, cmdLineOptions["mmap"].as<bool>(), ioProfile);
+  if ( cmdLineOptions.count("io-profile") > 0 && myodim::printInfo ) {
+    std::cout << myodim::ioReport(ioProfile, ioStart, -1.0) << std::endl;
+  }
 
   return 0;
 }
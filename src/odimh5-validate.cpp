@@ -1,10 +1,28 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cstdio>
+#include <algorithm>
+#include <thread>
 #include "class_H5Layout.hpp"
 #include "class_OdimStandard.hpp"
 #include "module_Compare.hpp"
+#include "module_FileAccess.hpp"
 #include "cxxopts.hpp"
 
+static std::vector<char> readStdin() {
+  std::vector<char> buffer;
+  size_t filled = 0;
+  size_t n = 0;
+  do {
+    buffer.resize(filled + (1<<20));
+    n = std::fread(buffer.data()+filled, 1, buffer.size()-filled, stdin);
+    filled += n;
+  } while ( n > 0 );
+  buffer.resize(filled);
+  return buffer;
+}
+
 int main(int argc, const char* argv[]) {
   
   //check and parse arguments
@@ -25,24 +43,77 @@ int main(int argc, const char* argv[]) {
     ("checkExtras", "check the presence of extra entries, not mentioned in the standard, default is False",  
         cxxopts::value<bool>()->default_value("false"))
     ("noInfo", "don`t print INFO messages, only WARNINGs and ERRORs, default is False",  
-        cxxopts::value<bool>()->default_value("false"));
+        cxxopts::value<bool>()->default_value("false"))
+    ("prefetchValues", "read all attribute values into memory while exploring the file, default is False",
+        cxxopts::value<bool>()->default_value("false"))
+    ("stdin", "read the input ODIM-H5 file from the standard input instead of the -i option, default is False",
+        cxxopts::value<bool>()->default_value("false"))
+    ("mmap", "read the input file through mmap instead of the default HDF5 file driver, default is False",
+        cxxopts::value<bool>()->default_value("false"))
+    ("nativeReader", "explore the file by the built-in reader of the HDF5 metadata, the HDF5 library is used only for what it doesn`t support, default is False",
+        cxxopts::value<bool>()->default_value("false"))
+    ("snapshotCache", "directory to save the explored file layouts to and to load them from at the next validation of the same file",
+        cxxopts::value<std::string>())
+    ("snapshotHash", "identify the files also by a hash of their content for the --snapshotCache, default is False",
+        cxxopts::value<bool>()->default_value("false"))
+    ("workers", "number of threads checking the standard entries, the output is the same for any number, default is 0 - the number of cores",
+        cxxopts::value<unsigned>()->default_value("0"))
+    ("io-profile", "HDF5 file access profile - possible values: default, network-fs, "
+                   "the achieved I/O counts are reported at the end, default is default",
+        cxxopts::value<std::string>()->default_value("default"));
 
   
   auto cmdLineOptions = options.parse(argc, argv);
-  if ( cmdLineOptions.count("input") != 1 || cmdLineOptions.count("help") > 0 ) {
+  const bool fromStdin{cmdLineOptions["stdin"].as<bool>()};
+  if ( (cmdLineOptions.count("input") != 1 && !fromStdin) || cmdLineOptions.count("help") > 0 ) {
     std::cout << options.help({"Mandatory", "Optional"}) << std::endl;
     return -1;
   }
   
   myodim::printInfo = !(cmdLineOptions["noInfo"].as<bool>());
+  // the library checks the entries in one thread unless told otherwise, the validator uses all the cores by default
+  myodim::compareWorkers = cmdLineOptions["workers"].as<unsigned>();
+  if ( myodim::compareWorkers == 0 ) myodim::compareWorkers = std::max(std::thread::hardware_concurrency(), 1u);
   
   //load the hdf5 input file layout
-  std::string h5File(cmdLineOptions["input"].as<std::string>());
-  myodim::H5Layout h5layout(h5File);
+  const std::string ioProfile{cmdLineOptions["io-profile"].as<std::string>()};
+  if ( ioProfile != "default" && (fromStdin || cmdLineOptions["mmap"].as<bool>()) ) {
+    // the file image in memory is opened by the core driver, the file access profile would be ignored
+    std::cout << "ERROR - the --io-profile option can`t be combined with the --stdin or --mmap options" << std::endl;
+    return -1;
+  }
+  const bool reportIo{cmdLineOptions.count("io-profile") > 0 && myodim::printInfo};
+  const myodim::IoCounts ioStart = myodim::currentIoCounts();
+  std::string h5File{"stdin"};
+  std::vector<char> h5Image;
+  myodim::H5Layout h5layout;
+  h5layout.setValuePrefetch(cmdLineOptions["prefetchValues"].as<bool>());
+  h5layout.setMmap(cmdLineOptions["mmap"].as<bool>());
+  h5layout.setNativeReader(cmdLineOptions["nativeReader"].as<bool>());
+  h5layout.setIoProfile(ioProfile);
+  if ( cmdLineOptions.count("snapshotCache") == 1 ) {
+    h5layout.setSnapshotCache(cmdLineOptions["snapshotCache"].as<std::string>(), cmdLineOptions["snapshotHash"].as<bool>());
+  }
+  const bool onlyValueCheck{cmdLineOptions["onlyValueCheck"].as<bool>()};
+  if ( onlyValueCheck && cmdLineOptions.count("valueTable") == 1 && !cmdLineOptions["checkExtras"].as<bool>() ) {
+    // only the subtrees with the checked values are explored
+    std::vector<std::string> targets;
+    for (const auto& entry : myodim::OdimStandard(cmdLineOptions["valueTable"].as<std::string>()).entries) {
+      targets.push_back(entry.node);
+    }
+    h5layout.setExploreTargets(targets);
+  }
+  if ( fromStdin ) {
+    h5Image = readStdin();
+    h5layout.exploreImage(h5Image.data(), h5Image.size(), h5File);
+  }
+  else {
+    h5File = cmdLineOptions["input"].as<std::string>();
+    h5layout.explore(h5File);
+  }
   
   myodim::OdimStandard odimStandard;
 
-  const bool onlyValueCheck{cmdLineOptions["onlyValueCheck"].as<bool>()};
   if ( !onlyValueCheck ) {
     std::string csvFile{""};
     if ( cmdLineOptions.count("csv") == 1 ) {
@@ -91,6 +162,9 @@ int main(int argc, const char* argv[]) {
   catch (const std::exception& e) {
     std::cout << e.what() << std::endl;
   }
+  if ( reportIo ) {
+    std::cout << myodim::ioReport(ioProfile, ioStart, h5layout.metadataCacheHitRate()) << std::endl;
+  }
   if ( isCompliant ) {
     if ( myodim::printInfo ) {
       std::string message = "INFO - OK - the file " + h5File + " is a standard-compliant ODIM-H5 file";
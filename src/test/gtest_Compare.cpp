@@ -296,6 +296,39 @@ TEST(testCompare, checkValueForArraysWorks) {
   ASSERT_TRUE( errorMessage.empty() );
 }
 
+TEST(testCompare, compiledValueExpressionGivesTheSameResultsAsTheString) {
+  const ValueExpression interval{">=1.0&&<2.0||==5.0"};
+  std::string errorMessage = "";
+  for (const double myNum : {0.5, 1.0, 1.5, 2.0, 5.0, 5.5}) {
+    std::string stringErrorMessage = "";
+    ASSERT_EQ( checkValue(myNum, interval, errorMessage),
+               checkValue(myNum, interval.source(), stringErrorMessage) );
+    ASSERT_EQ( errorMessage, stringErrorMessage );
+  }
+
+  const ValueExpression tolerance{"1.0+-0.1"};
+  ASSERT_THAT( tolerance.terms(), SizeIs(1) );
+  ASSERT_EQ( tolerance.terms()[0].comparison, ValueExpression::Within );
+  ASSERT_TRUE( checkValue(1.05, tolerance, errorMessage) );
+  ASSERT_FALSE( checkValue(1.15, tolerance, errorMessage) );
+
+  const bool isArray = true;
+  const ValueExpression statistics{"first<1.0||last>3.0", isArray};
+  ASSERT_TRUE( checkValue(std::vector<double>{1.256, 2.256, 3.567}, statistics, errorMessage) );
+  ASSERT_FALSE( checkValue(std::vector<double>{1.256, 2.256, 2.567}, statistics, errorMessage) );
+}
+
+TEST(testCompare, wrongValueExpressionThrowsOnlyWhenEvaluated) {
+  const ValueExpression wrong{"==1.254||==1.256|||==1.253"};
+  ASSERT_FALSE( wrong.isValid() );
+  std::string errorMessage = "";
+  ASSERT_ANY_THROW( checkValue(1.254, wrong, errorMessage) );
+
+  const bool isArray = true;
+  const ValueExpression noStatistics{"1.256", isArray};
+  ASSERT_ANY_THROW( checkValue(std::vector<double>{1.256}, noStatistics, errorMessage) );
+}
+
 TEST(testCompare, canCheckWhatSource) {
   std::string whatSource = "WMO:11812,NOD:skjav";
   std::string basicRegex = "(WIGOS:.*)|"  //WIGOS format
@@ -376,6 +409,77 @@ TEST(testCompare, canCheckWhatSource) {
   ASSERT_FALSE( errorMessage.empty() );
 }
 
+TEST(testCompare, canParseWhatSourceIdentifiers) {
+  WhatSource parsed;
+  std::string errorMessage = "";
+  ASSERT_TRUE( parseWhatSource("WIGOS:0-246-0-101518,WMO:02925,RAD:FI49,PLC:Vimpeli,NOD:fivim", parsed, errorMessage) );
+  ASSERT_THAT( errorMessage, IsEmpty() );
+  ASSERT_THAT( parsed.wigos, Eq("0-246-0-101518") );
+  ASSERT_THAT( parsed.wmo, Eq("02925") );
+  ASSERT_THAT( parsed.rad, Eq("FI49") );
+  ASSERT_THAT( parsed.plc, Eq("Vimpeli") );
+  ASSERT_THAT( parsed.nod, Eq("fivim") );
+  ASSERT_THAT( parsed.org, IsEmpty() );
+
+  ASSERT_TRUE( parseWhatSource("ORG:215, CTY:644, CMT:MeteoSwiss (Switzerland)", parsed, errorMessage) );
+  ASSERT_THAT( parsed.cty, Eq("644") );
+  ASSERT_THAT( parsed.cmt, Eq("MeteoSwiss (Switzerland)") );
+
+  ASSERT_FALSE( parseWhatSource("NOD:sk\xC3\xA1javina", parsed, errorMessage) );   // only ASCII
+  ASSERT_THAT( errorMessage, HasSubstr("NOD:") );
+
+  errorMessage = "";
+  ASSERT_FALSE( parseWhatSource("WMO:11812,FOO:bar", parsed, errorMessage) );
+  ASSERT_THAT( errorMessage, HasSubstr("FOO:bar - not defined by the ODIM standard") );
+
+  errorMessage = "";
+  ASSERT_FALSE( parseWhatSource("WIGOS:0-246--101518", parsed, errorMessage) );
+  ASSERT_FALSE( parseWhatSource("WMO:118123", parsed, errorMessage) );
+  ASSERT_FALSE( parseWhatSource("", parsed, errorMessage) );
+}
+
+TEST(testCompare, whatSourceErrorsNameTheCheckedRule) {
+  const std::pair<std::string, std::string> wrongIds[] = {
+    {"WMO:1181", "WMO:<5 or 7 digits>"},
+    {"NOD:sk\xC3\xA1javina", "NOD:<ascii>"},
+    {"ORG:SHMU", "ORG:<digits>"},
+    {"CTY:", "CTY:<digits>"},
+    {"WIGOS:0-703-0", "WIGOS:<n>-<n>-<n>-<ascii id>"}
+  };
+  for (const auto& wrongId : wrongIds) {
+    WhatSource parsed;
+    std::string errorMessage = "";
+    ASSERT_FALSE( parseWhatSource(wrongId.first, parsed, errorMessage) );
+    ASSERT_THAT( errorMessage, Eq("with value \"" + wrongId.first + "\" doesn`t match the \"" +
+                                  wrongId.second + "\" assumed value") );
+  }
+
+  // RAD, PLC and CMT accept any value, only a wrong key fails
+  WhatSource parsed;
+  std::string errorMessage = "";
+  ASSERT_FALSE( parseWhatSource("RAD:SK41,PLX:Maly Javornik", parsed, errorMessage) );
+  ASSERT_THAT( errorMessage, Eq("source type in /what/source - PLX:Maly Javornik - not defined by the ODIM standard") );
+}
+
+// these matched the former per-identifier regexes, the values are checked by the ODIM rules now
+TEST(testCompare, whatSourceRejectsWhatTheRegexesLetThrough) {
+  const std::string basicRegex = "(WIGOS:.*)|(WMO:.*)|(RAD:.*)|(PLC:.*)|(NOD:.*)|(ORG:.*)|(CTY:.*)|(CMT:.*)";
+  const std::string wrongSources[] = {
+    "ORG:ABC",
+    "CTY:SK",
+    "NOD:skjav,CTY:SK",
+    "WIGOS:0-20000-0-",
+    "WIGOS:0-246--101518",
+    "WMO:0011812A",
+    "NOD:sk\xC3\xA1javina"
+  };
+  for (const auto& whatSource : wrongSources) {
+    std::string errorMessage = "";
+    ASSERT_FALSE( checkWhatSource(whatSource, basicRegex, errorMessage) ) << whatSource;
+    ASSERT_THAT( errorMessage, HasSubstr("doesn`t match") );
+  }
+}
+
 TEST(testCompare, compareWorksForV24Files) {
   H5Layout h5Lay(TEST_ODIM_FILE_V24);
   OdimStandard oStand(TEST_CSV_FILE_V24);
@@ -386,6 +490,37 @@ TEST(testCompare, compareWorksForV24Files) {
   ASSERT_TRUE( compare(h5Lay, oStand, checkOptional, checkExtras, &failedEntries) );
 }
 
+TEST(testCompare, compareGivesSameResultsFromLayoutSnapshot) {
+  printInfo = false; // turn-off INFO messages
+  const std::string snapshotDir = "./out";
+  const std::string dataFiles[] = {TEST_ODIM_FILE, "./data/test/T_PAJZ41_C_LZIB_20231023000000.hdf"};
+  OdimStandard oStand(TEST_CSV_FILE);
+  oStand.updateWithCsv(UPDATE_CSV_FILE);
+  const bool checkOptional = true;
+  const bool checkExtras = true;
+
+  for (const auto& dataFile : dataFiles) {
+    H5Layout h5Lay(dataFile);
+    OdimStandard failedEntries;
+    const bool isCompliant = compare(h5Lay, oStand, checkOptional, checkExtras, &failedEntries);
+
+    H5Layout toSnapshot;
+    toSnapshot.setSnapshotCache(snapshotDir);
+    toSnapshot.explore(dataFile);
+    H5Layout fromSnapshot;
+    fromSnapshot.setSnapshotCache(snapshotDir);
+    fromSnapshot.explore(dataFile);
+    OdimStandard failedEntriesFromSnapshot;
+
+    ASSERT_TRUE( fromSnapshot.isFromSnapshot() );
+    ASSERT_THAT( compare(fromSnapshot, oStand, checkOptional, checkExtras, &failedEntriesFromSnapshot), Eq(isCompliant) );
+    ASSERT_THAT( failedEntriesFromSnapshot.entries.size(), Eq(failedEntries.entries.size()) );
+    for (size_t i=0; i<failedEntries.entries.size(); ++i) {
+      ASSERT_THAT( failedEntriesFromSnapshot.entries[i].node, Eq(failedEntries.entries[i].node) );
+    }
+  }
+}
+
 TEST(testCompare, canCheckWhatSourceInV24) {
   std::string whatSource = "WMO:11812,NOD:skjav";
   std::string basicRegex = "((WIGOS:.*)|"  //WIGOS format
@@ -479,3 +614,94 @@ TEST(BUGCompare, checkValueForWhatSourceStringsNOTWorkingForSwissData) {
 
   ASSERT_TRUE(checkWhatSource(myStr, assumedStr, errorMessage) );
 }
+
+TEST(testCompare, checkExtrasReportsEveryUnknownEntryOnce) {
+  printInfo = true;
+  H5Layout h5Lay("./data/test/T_PAJZ41_C_LZIB_20231023000000.hdf");
+  OdimStandard oStand;
+  oStand.entries.push_back(OdimEntry("/what", "Group", "String", "TRUE", "", ""));
+  oStand.entries.push_back(OdimEntry("/what/object", "Attribute", "String", "TRUE", "", ""));
+  oStand.entries.push_back(OdimEntry("/dataset[0-9]+/data[0-9]+/data", "Dataset", "String", "FALSE", "", ""));
+
+  testing::internal::CaptureStdout();
+  compare(h5Lay, oStand, true, true);
+  const std::string output = testing::internal::GetCapturedStdout();
+  printInfo = false;
+
+  ASSERT_THAT( output, Not(HasSubstr("entry \"/what\" is not mentioned")) );
+  ASSERT_THAT( output, Not(HasSubstr("entry \"/what/object\" is not mentioned")) );
+  ASSERT_THAT( output, Not(HasSubstr("entry \"/dataset1/data1/data\" is not mentioned")) );
+  ASSERT_THAT( output, HasSubstr("INFO - extra feature - entry \"/what/date\" is not mentioned in the standard.") );
+  ASSERT_THAT( output, HasSubstr("INFO - extra feature - entry \"/dataset1\" is not mentioned in the standard.") );
+  ASSERT_THAT( output, HasSubstr("WARNING - STRSIZE error - attribute /how/system") );
+  size_t count = 0;
+  for (size_t p = output.find("entry \"/what/date\""); p != std::string::npos; p = output.find("entry \"/what/date\"", p+1)) ++count;
+  ASSERT_THAT( count, Eq(1u) );
+}
+
+static void createFileWithTenDatasets(const std::string& filePath, const bool withLastProduct) {
+  hid_t f = H5Fcreate(filePath.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t space = H5Screate(H5S_SCALAR);
+  for (int i=1; i<=10; ++i) {
+    const std::string dataset = "/dataset"+std::to_string(i);
+    hid_t g = H5Gcreate2(f, dataset.c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t what = H5Gcreate2(g, "what", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t a = H5Acreate2(what, i < 10 || withLastProduct ? "product" : "prodpar",
+                         H5T_NATIVE_INT64, space, H5P_DEFAULT, H5P_DEFAULT);
+    const int64_t value = i;
+    H5Awrite(a, H5T_NATIVE_INT64, &value);
+    H5Aclose(a);
+    H5Gclose(what);
+    H5Gclose(g);
+  }
+  H5Sclose(space);
+  H5Fclose(f);
+}
+
+TEST(testCompare, mandatoryEntryIsCheckedInAllParentsOfTheSameDepth) {
+  printInfo = false;
+  OdimStandard oStand;
+  oStand.entries.push_back(OdimEntry("/dataset[1-9][0-9]*/what/product", "Attribute", "Integer", "TRUE", "", ""));
+  oStand.entries.push_back(OdimEntry("/dataset[1-9][0-9]*/what/prodpar", "Attribute", "Integer", "FALSE", "", ""));
+  const std::string filePath = "./out/testCompare.tenDatasets.h5";
+
+  createFileWithTenDatasets(filePath, true);
+  {
+    H5Layout complete(filePath);
+    ASSERT_TRUE( compare(complete, oStand, false, false) );
+  }
+
+  createFileWithTenDatasets(filePath, false);   // /dataset10 has the same depth as the others, but a longer name
+  H5Layout incomplete(filePath);
+  OdimStandard failedEntries;
+  ASSERT_FALSE( compare(incomplete, oStand, false, false, &failedEntries) );
+  ASSERT_THAT( failedEntries.entries.size(), Eq(1u) );
+  ASSERT_THAT( failedEntries.entries[0].node, StrEq("/dataset[1-9][0-9]*/what/product") );
+}
+
+TEST(testCompare, parallelCheckGivesTheSameOutputAsSerial) {
+  printInfo = true;
+  const auto run = [](const unsigned workers, OdimStandard& failedEntries, bool& isCompliant) {
+    compareWorkers = workers;
+    H5Layout h5Lay(TEST_ODIM_FILE);
+    OdimStandard oStand(TEST_CSV_FILE);
+    oStand.updateWithCsv("./data/example/T_PAGZ41_C_LZIB.values.wrong.csv");
+    testing::internal::CaptureStdout();
+    isCompliant = compare(h5Lay, oStand, true, true, &failedEntries);
+    return testing::internal::GetCapturedStdout();
+  };
+  OdimStandard serialFailed, parallelFailed;
+  bool serialCompliant, parallelCompliant;
+  const std::string serial = run(1, serialFailed, serialCompliant);
+  const std::string parallel = run(8, parallelFailed, parallelCompliant);
+  compareWorkers = 1;
+  printInfo = false;
+
+  ASSERT_FALSE( serial.empty() );
+  ASSERT_THAT( parallel, StrEq(serial) );
+  ASSERT_THAT( parallelCompliant, Eq(serialCompliant) );
+  ASSERT_THAT( parallelFailed.entries.size(), Eq(serialFailed.entries.size()) );
+  for (size_t i=0; i<serialFailed.entries.size(); ++i) {
+    ASSERT_THAT( parallelFailed.entries[i].node, StrEq(serialFailed.entries[i].node) );
+  }
+}
@@ -5,6 +5,7 @@
 #include "gmock/gmock.h"
 #include "module_Correct.hpp"
 #include "module_Compare.hpp"
+#include "class_H5Handle.hpp"
 
 using namespace testing;
 using namespace myodim;
@@ -100,6 +101,21 @@ TEST(testRepair, addAttributeThrowsWhenNoOrWrongValuePresent) {
   ASSERT_ANY_THROW( correct(TEST_IN_FILE, testOutFile, toAdd) );
 }
 
+TEST(testRepair, leavesNoOpenHdf5Objects) {
+  const std::string testOutFile = TEST_OUT_DIR+"testRepair"+"."+"leavesNoOpenHdf5Objects"+".hdf";
+  std::remove(testOutFile.c_str());
+
+  printInfo = false;
+
+  ASSERT_THAT( H5Handle::openObjectCount(), Eq(0u) );
+  OdimStandard toAdd(CSV_CORRECT_ALL);
+  ASSERT_NO_THROW( correct(TEST_IN_FILE, testOutFile, toAdd) );
+  ASSERT_THAT( H5Handle::openObjectCount(), Eq(0u) );
+  toAdd.readFromCsv(CSV_TO_ADD_WRONG);
+  ASSERT_ANY_THROW( correct(TEST_IN_FILE, testOutFile, toAdd) );
+  ASSERT_THAT( H5Handle::openObjectCount(), Eq(0u) );
+}
+
 TEST(testRepair, worksWithRegexInNodes) {
   const std::string testOutFile = TEST_OUT_DIR+"testRepair"+"."+"worksWithRegexInNodes"+".hdf";
   std::remove(testOutFile.c_str());
@@ -1,8 +1,15 @@
 #include <iostream>
 #include <string>
+#include <fstream>
+#include <iterator>
+#include <regex>
+#include <set>
+#include <limits>
+#include <dirent.h>
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "class_H5Layout.hpp"
+#include "module_Statistics.hpp"
 
 using namespace testing;
 using namespace myodim;
@@ -63,6 +70,73 @@ TEST(testH5Layout, canCheckEntryExistence) {
   ASSERT_FALSE( h5layout.hasDataset("/dataset1/data1x/data") );
 }
 
+TEST(testH5Layout, canFindIndexOfEntry) {
+  const H5Layout h5layout(TEST_ODIM_FILE);
+
+  const size_t group = h5layout.findGroup("/dataset1/what");
+  ASSERT_THAT( group, Ne(H5Layout::NOT_FOUND) );
+  ASSERT_THAT( h5layout.groups[group].name(), Eq("/dataset1/what") );
+  const size_t dataset = h5layout.findDataset("/dataset1/data1/data");
+  ASSERT_THAT( dataset, Ne(H5Layout::NOT_FOUND) );
+  ASSERT_THAT( h5layout.datasets[dataset].name(), Eq("/dataset1/data1/data") );
+  const size_t attribute = h5layout.findAttribute("/what/object");
+  ASSERT_THAT( attribute, Ne(H5Layout::NOT_FOUND) );
+  ASSERT_THAT( h5layout.attributes[attribute].name(), Eq("/what/object") );
+  ASSERT_THAT( h5layout.findGroup("/what/object"), Eq(H5Layout::NOT_FOUND) );
+  ASSERT_THAT( h5layout.findAttribute("/what/objectx"), Eq(H5Layout::NOT_FOUND) );
+}
+
+TEST(testH5Layout, candidatesContainAllRegexMatches) {
+  const H5Layout h5layout(TEST_ODIM_FILE);
+  const std::vector<std::string> regexes = {"/dataset[1-9][0-9]*", "/dataset[1-9][0-9]*/what/gain",
+                                            ".*how/wavelength", "/what/.*", ".*", "/dataset1/data1/data",
+                                            "/dataset1|/what", "(/dataset[0-9]+)?/how/\\w+"};
+  for (const auto& regexStr : regexes) {
+    const std::regex r(regexStr);
+    std::vector<size_t> candidates;
+    h5layout.candidateAttributes(regexStr, candidates);
+    ASSERT_TRUE( std::is_sorted(candidates.begin(), candidates.end()) ) << regexStr;
+    std::set<size_t> candidateSet(candidates.begin(), candidates.end());
+    for (size_t i=0; i<h5layout.attributes.size(); ++i) {
+      if ( std::regex_match(h5layout.attributes[i].name(), r) ) {
+        ASSERT_THAT( candidateSet.count(i), Eq(1u) ) << regexStr << " " << h5layout.attributes[i].name();
+      }
+    }
+    h5layout.candidateGroups(regexStr, candidates);
+    candidateSet = std::set<size_t>(candidates.begin(), candidates.end());
+    for (size_t i=0; i<h5layout.groups.size(); ++i) {
+      if ( std::regex_match(h5layout.groups[i].name(), r) ) {
+        ASSERT_THAT( candidateSet.count(i), Eq(1u) ) << regexStr << " " << h5layout.groups[i].name();
+      }
+    }
+  }
+
+  std::vector<size_t> candidates;
+  h5layout.candidateAttributes("/dataset[1-9][0-9]*/what/gain", candidates);
+  ASSERT_THAT( candidates.size(), Lt(h5layout.attributes.size()/4) );
+  for (const size_t i : candidates) {
+    const std::string name = h5layout.attributes[i].name();
+    ASSERT_THAT( name, StartsWith("/dataset") );
+    ASSERT_THAT( name, EndsWith("/what/gain") );
+  }
+  h5layout.candidateDatasets("/dataset1/data[0-9]+/data", candidates);
+  ASSERT_THAT( candidates.size(), Gt(0u) );
+  h5layout.candidateAttributes("/nothing/.*", candidates);
+  ASSERT_TRUE( candidates.empty() );
+}
+
+TEST(testH5Layout, entryExistenceDoesNotDependOnWasFound) {
+  H5Layout h5layout(TEST_ODIM_FILE);
+
+  for (auto& a : h5layout.attributes) a.wasFound() = true;
+  for (auto& g : h5layout.groups) g.wasFound() = true;
+
+  ASSERT_TRUE( h5layout.hasAttribute("/where/lon") );
+  ASSERT_TRUE( h5layout.hasGroup("/dataset1/where") );
+  ASSERT_TRUE( h5layout.hasDataset("/dataset1/data1/data") );
+  ASSERT_FALSE( h5layout.hasAttribute("/where/lonx") );
+}
+
 TEST(testH5Layout, canGetAttributeValues) {
   const H5Layout h5layout(TEST_ODIM_FILE);
   std::string attrName = "/what/object";
@@ -118,6 +192,27 @@ TEST(testH5Layout, isXXXAttributeThrowsOnError) {
   ASSERT_ANY_THROW( h5layout.isReal64Attribute("/how/startepochsx") );
 }
 
+TEST(testH5Layout, recordsAttributeInfoDuringExplore) {
+  const H5Layout h5layout(TEST_ODIM_FILE);
+
+  const h5AttributeInfo& lon = h5layout.attributeInfo("/where/lon");
+  ASSERT_THAT( lon.typeClass, Eq(H5T_FLOAT) );
+  ASSERT_THAT( lon.precision, Eq(64u) );
+  ASSERT_THAT( lon.rank, Eq(0) );
+
+  const h5AttributeInfo& object = h5layout.attributeInfo("/what/object");
+  ASSERT_THAT( object.typeClass, Eq(H5T_STRING) );
+  ASSERT_THAT( object.strpad, Eq(H5T_STR_NULLTERM) );
+  ASSERT_FALSE( object.isVariableStr );
+  ASSERT_THAT( object.size, Eq(5u) );
+
+  const h5AttributeInfo& startazA = h5layout.attributeInfo("/dataset1/how/startazA");
+  ASSERT_THAT( startazA.rank, Eq(1) );
+  ASSERT_THAT( startazA.numElements(), Eq(360u) );
+
+  ASSERT_ANY_THROW( h5layout.attributeInfo("/where/lonx") );
+}
+
 TEST(testH5Layout, canSayDatasetIsUchar) {
   const H5Layout h5layout(TEST_ODIM_FILE);
   const h5Entry dataset = h5layout.datasets[0];
@@ -177,6 +272,34 @@ TEST(testH5Layout, canReturnMinMaxMeanOfAttribute) {
   ASSERT_THAT( mean, Lt(185.0) );
 }
 
+TEST(testH5Layout, arrayStatisticsComputeOnlyTheNeededValues) {
+  const std::vector<double> values = {3.0, -1.5, std::nan(""), 7.25, 2.0, 0.5, 4.0};   // a tail after the vector lanes
+  ArrayStatistics<double> statistics;
+  arrayStatistics(values.data(), values.size(), NEED_MIN | NEED_MAX, statistics);
+  ASSERT_THAT( statistics.first, DoubleEq(3.0) );
+  ASSERT_THAT( statistics.last, DoubleEq(4.0) );
+  ASSERT_THAT( statistics.min, DoubleEq(-1.5) );     // NaN skipped
+  ASSERT_THAT( statistics.max, DoubleEq(7.25) );
+  ASSERT_TRUE( std::isnan(statistics.mean) );        // not needed, not computed
+
+  const std::vector<int64_t> intValues = {5, -3, 12, 0, 7, -8, 9, 2, 1};
+  ArrayStatistics<int64_t> intStatistics;
+  arrayStatistics(intValues.data(), intValues.size(), NEED_ALL, intStatistics);
+  ASSERT_THAT( intStatistics.first, Eq(5) );
+  ASSERT_THAT( intStatistics.last, Eq(1) );
+  ASSERT_THAT( intStatistics.min, Eq(-8) );
+  ASSERT_THAT( intStatistics.max, Eq(12) );
+  ASSERT_THAT( intStatistics.mean, DoubleEq(25.0/9.0) );
+}
+
+TEST(testH5Layout, arrayStatisticsMeanDoesNotOverflowForLargeIntegers) {
+  const int64_t big = std::numeric_limits<int64_t>::max() / 2;
+  const std::vector<int64_t> values = {big, big, big, big, big, big};   // the int64_t sum would overflow
+  ArrayStatistics<int64_t> statistics;
+  arrayStatistics(values.data(), values.size(), NEED_MEAN, statistics);
+  ASSERT_THAT( statistics.mean, DoubleEq(static_cast<double>(big)) );
+}
+
 TEST(testH5Layout, canSayIs2DArrayAttribute) {
   const H5Layout h5layout(TEST_ODIM_FILE_V24); // this test file needs to be created with the dev-create-v24-file-for-test program
 
@@ -227,6 +350,464 @@ TEST(testH5Layout, canWorkWithPalette) {
   ASSERT_TRUE( h5layout.isLinkAttribute("/CT/PALETTE") );
 }
 
+TEST(testH5Layout, prefetchedValuesAreSameAsReadFromFile) {
+  const H5Layout h5layout(TEST_ODIM_FILE);
+  H5Layout prefetched;
+  prefetched.setValuePrefetch(true);
+  prefetched.explore(TEST_ODIM_FILE);
+
+  ASSERT_THAT( h5layout.prefetchedValuesBytes(), Eq(0u) );
+  ASSERT_THAT( prefetched.prefetchedValuesBytes(), Gt(0u) );
+  ASSERT_THAT( prefetched.attributes.size(), Eq(h5layout.attributes.size()) );
+  for (const auto& a : h5layout.attributes) {
+    if ( h5layout.isStringAttribute(a.name()) ) {
+      std::string value, prefetchedValue;
+      h5layout.getAttributeValue(a.name(), value);
+      prefetched.getAttributeValue(a.name(), prefetchedValue);
+      ASSERT_THAT( prefetchedValue, Eq(value) );
+    }
+    else if ( !h5layout.isLinkAttribute(a.name()) ) {
+      std::vector<double> values, prefetchedValues;
+      h5layout.getAttributeValue(a.name(), values);
+      prefetched.getAttributeValue(a.name(), prefetchedValues);
+      ASSERT_THAT( prefetchedValues, ContainerEq(values) );
+    }
+  }
+}
+
+TEST(testH5Layout, prefetchRespectsMemoryCap) {
+  H5Layout prefetched, prefetchedWithCap;
+  prefetched.setValuePrefetch(true);
+  prefetched.explore(TEST_ODIM_FILE);
+  prefetchedWithCap.setValuePrefetch(true, 1024);
+  prefetchedWithCap.explore(TEST_ODIM_FILE);
+  std::vector<double> values, cappedValues;
+
+  ASSERT_THAT( prefetchedWithCap.prefetchedValuesBytes(), Lt(prefetched.prefetchedValuesBytes()) );
+  ASSERT_NO_THROW( prefetched.getAttributeValue("/dataset1/how/startazA", values) );
+  ASSERT_NO_THROW( prefetchedWithCap.getAttributeValue("/dataset1/how/startazA", cappedValues) );
+  ASSERT_THAT( values.size(), Eq(360u) );
+  ASSERT_THAT( cappedValues, ContainerEq(values) );
+}
+
+TEST(testH5Layout, parentHandlesAreReusedBetweenAccessors) {
+  H5Layout h5layout(TEST_ODIM_FILE);
+  double gain, offset, nodata, undetect;
+  h5layout.getAttributeValue("/dataset1/data1/what/gain", gain);
+  h5layout.getAttributeValue("/dataset1/data1/what/offset", offset);
+  h5layout.getAttributeValue("/dataset1/data1/what/nodata", nodata);
+  h5layout.getAttributeValue("/dataset1/data1/what/undetect", undetect);
+
+  ASSERT_THAT( h5layout.handleCacheMisses(), Eq(1u) );
+  ASSERT_THAT( h5layout.handleCacheHits(), Eq(3u) );
+
+  H5Layout uncached;
+  uncached.setHandleCacheSize(0);
+  uncached.explore(TEST_ODIM_FILE);
+  double uncachedGain;
+  uncached.getAttributeValue("/dataset1/data1/what/gain", uncachedGain);
+  uncached.getAttributeValue("/dataset1/data1/what/gain", uncachedGain);
+  ASSERT_THAT( uncached.handleCacheHits(), Eq(0u) );
+  ASSERT_THAT( uncachedGain, Eq(gain) );
+
+  h5layout.explore(TEST_ODIM_FILE);
+  ASSERT_THAT( h5layout.handleCacheHits(), Eq(0u) );
+  ASSERT_THAT( h5layout.handleCacheMisses(), Eq(0u) );
+}
+
+TEST(testH5Layout, canExploreFileImageFromMemory) {
+  std::ifstream file(TEST_ODIM_FILE, std::ios::binary);
+  const std::vector<char> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  const H5Layout fromFile(TEST_ODIM_FILE);
+  const H5Layout fromImage(image.data(), image.size(), "memory");
+  std::string object;
+  std::vector<double> values, imageValues;
+
+  ASSERT_THAT( fromImage.filePath(), Eq("memory") );
+  ASSERT_THAT( fromImage.groups.size(), Eq(fromFile.groups.size()) );
+  ASSERT_THAT( fromImage.datasets.size(), Eq(fromFile.datasets.size()) );
+  ASSERT_THAT( fromImage.attributes.size(), Eq(fromFile.attributes.size()) );
+  fromImage.getAttributeValue("/what/object", object);
+  ASSERT_THAT( object, Eq("PVOL") );
+  fromFile.getAttributeValue("/dataset1/how/startazA", values);
+  fromImage.getAttributeValue("/dataset1/how/startazA", imageValues);
+  ASSERT_THAT( imageValues, ContainerEq(values) );
+
+  const std::string notHdf5(1024, 'x');
+  H5Layout h5layout;
+  ASSERT_THROW( h5layout.exploreImage(notHdf5.data(), notHdf5.size(), "memory"), std::runtime_error );
+}
+
+TEST(testH5Layout, mmapModeGivesTheSameLayout) {
+  const H5Layout fromFile(TEST_ODIM_FILE);
+  H5Layout mapped;
+  mapped.setMmap(true);
+  mapped.explore(TEST_ODIM_FILE);
+  std::vector<double> values, mappedValues;
+
+  ASSERT_THAT( mapped.filePath(), Eq(TEST_ODIM_FILE) );
+  ASSERT_THAT( mapped.attributes.size(), Eq(fromFile.attributes.size()) );
+  for (size_t i=0; i<fromFile.attributes.size(); ++i) {
+    ASSERT_THAT( mapped.attributes[i].name(), Eq(fromFile.attributes[i].name()) );
+  }
+  fromFile.getAttributeValue("/dataset1/how/startazA", values);
+  mapped.getAttributeValue("/dataset1/how/startazA", mappedValues);
+  ASSERT_THAT( mappedValues, ContainerEq(values) );
+  ASSERT_THROW( mapped.explore("./data/example/notExistingFile.h5"), std::runtime_error );
+}
+
+TEST(testH5Layout, ioProfilesGiveTheSameLayout) {
+  const H5Layout fromFile(TEST_ODIM_FILE);
+  for (const std::string profile : {"default", "network-fs"}) {
+    H5Layout h5layout;
+    h5layout.setIoProfile(profile);
+    h5layout.explore(TEST_ODIM_FILE);
+    double gain, expectedGain;
+    h5layout.getAttributeValue("/dataset1/data1/what/gain", gain);
+    fromFile.getAttributeValue("/dataset1/data1/what/gain", expectedGain);
+    ASSERT_THAT( h5layout.attributes.size(), Eq(fromFile.attributes.size()) );
+    ASSERT_THAT( gain, Eq(expectedGain) );
+    ASSERT_THAT( h5layout.metadataCacheHitRate(), Ge(0.0) );
+  }
+  H5Layout h5layout;
+  ASSERT_THROW( h5layout.setIoProfile("unknown"), std::runtime_error );
+  ASSERT_THROW( h5layout.setIoProfile("metadata"), std::runtime_error );
+  ASSERT_THAT( h5layout.metadataCacheHitRate(), Eq(-1.0) );
+}
+
+TEST(testH5Layout, targetedExploreVisitsOnlyMatchingSubtrees) {
+  const H5Layout full(TEST_ODIM_FILE);
+  H5Layout targeted;
+  targeted.explore(TEST_ODIM_FILE, {"/dataset1/where/nbins", "/Conventions"});
+  int64_t nbins;
+
+  ASSERT_THAT( targeted.attributes.size(), Lt(full.attributes.size()) );
+  ASSERT_TRUE( targeted.hasAttribute("/dataset1/where/nbins") );
+  ASSERT_TRUE( targeted.hasAttribute("/Conventions") );
+  ASSERT_FALSE( targeted.hasGroup("/dataset2/where") );
+  ASSERT_FALSE( targeted.hasAttribute("/what/object") );
+  targeted.getAttributeValue("/dataset1/where/nbins", nbins);
+  ASSERT_THAT( nbins, Eq(960) );
+
+  // outside the targets, but in the file - read from there
+  std::string object;
+  ASSERT_TRUE( targeted.isStringAttribute("/what/object") );
+  ASSERT_TRUE( targeted.isInt64Attribute("/dataset2/where/nbins") );
+  targeted.getAttributeValue("/what/object", object);
+  ASSERT_THAT( object, Eq("PVOL") );
+  h5Error error;
+  ASSERT_THAT( targeted.findAttributeInfo("/what/nonexistent", error), IsNull() );
+  ASSERT_THAT( error.kind, Eq(h5Error::AttributeNotOpened) );
+  ASSERT_THAT( targeted.findAttributeInfo("/nonexistent/object", error), IsNull() );
+  ASSERT_THAT( error.kind, Eq(h5Error::NodeNotOpened) );
+
+  targeted.explore(TEST_ODIM_FILE, {"/dataset[0-9]+/data1/what/gain"});
+  for (const auto& a : full.attributes) {       // everything the target can match is there
+    if ( std::regex_match(a.name(), std::regex("/dataset[0-9]+/data1/what/gain")) ) {
+      ASSERT_TRUE( targeted.hasAttribute(a.name()) );
+    }
+  }
+  ASSERT_FALSE( targeted.hasAttribute("/what/object") );
+
+  targeted.explore(TEST_ODIM_FILE, {"/"});      // the targeted walk of the whole file is the same as the full one
+  ASSERT_THAT( targeted.groups.size(), Eq(full.groups.size()) );
+  ASSERT_THAT( targeted.datasets.size(), Eq(full.datasets.size()) );
+  ASSERT_THAT( targeted.attributes.size(), Eq(full.attributes.size()) );
+  for (size_t i=0; i<full.groups.size(); ++i) {
+    ASSERT_THAT( targeted.groups[i].name(), Eq(full.groups[i].name()) );
+  }
+  for (size_t i=0; i<full.attributes.size(); ++i) {
+    ASSERT_THAT( targeted.attributes[i].name(), Eq(full.attributes[i].name()) );
+  }
+
+  targeted.explore(TEST_ODIM_FILE, {".*/gain"});    // no literal prefix - the whole file
+  ASSERT_THAT( targeted.attributes.size(), Eq(full.attributes.size()) );
+}
+
+TEST(testH5Layout, targetsApplyOnlyToTheirExplore) {
+  const H5Layout full(TEST_ODIM_FILE);
+  H5Layout h5layout;
+  h5layout.explore(TEST_ODIM_FILE, {"/dataset1/where/nbins"});
+  ASSERT_FALSE( h5layout.hasAttribute("/what/object") );
+
+  h5layout.explore(TEST_ODIM_FILE);
+  ASSERT_THAT( h5layout.groups.size(), Eq(full.groups.size()) );
+  ASSERT_THAT( h5layout.datasets.size(), Eq(full.datasets.size()) );
+  ASSERT_THAT( h5layout.attributes.size(), Eq(full.attributes.size()) );
+  ASSERT_TRUE( h5layout.hasAttribute("/what/object") );
+  ASSERT_TRUE( h5layout.hasGroup("/dataset2/where") );
+
+  h5layout.setExploreTargets({"/Conventions"});      // these stay until changed
+  h5layout.explore(TEST_ODIM_FILE, {"/dataset1/where/nbins"});
+  ASSERT_THROW( h5layout.explore("./data/nonexistent.h5", {"/what"}), std::runtime_error );
+  h5layout.explore(TEST_ODIM_FILE);
+  ASSERT_TRUE( h5layout.hasAttribute("/Conventions") );
+  ASSERT_FALSE( h5layout.hasAttribute("/dataset1/where/nbins") );
+  ASSERT_FALSE( h5layout.hasAttribute("/what/object") );
+  h5layout.setExploreTargets({});
+  h5layout.explore(TEST_ODIM_FILE);
+  ASSERT_THAT( h5layout.attributes.size(), Eq(full.attributes.size()) );
+}
+
+TEST(testH5Layout, pathsAreStoredInTrieWithInternedComponents) {
+  const H5Layout h5layout(TEST_ODIM_FILE);
+  const H5PathTrie& paths = h5layout.paths();
+  std::string name;
+
+  ASSERT_THAT( paths.componentCount(), Lt(paths.size()/4) );
+  for (const auto& a : h5layout.attributes) {
+    a.name(name);
+    ASSERT_THAT( paths.find(name), Eq(a.node()) );
+    ASSERT_THAT( paths.path(a.node()), Eq(name) );
+  }
+  ASSERT_THAT( paths.find("/"), Eq(H5PathTrie::ROOT) );
+  ASSERT_THAT( h5layout.groups.front().name(), Eq("/") );
+  ASSERT_THAT( paths.component(paths.find("/dataset12/data1/what")), Eq("what") );
+  ASSERT_THAT( paths.path(paths.parent(paths.find("/dataset12/data1/what"))), Eq("/dataset12/data1") );
+  ASSERT_THAT( paths.find("/dataset1/what/"), Eq(H5PathTrie::NO_NODE) );
+  ASSERT_THAT( paths.find("dataset1/what"), Eq(H5PathTrie::NO_NODE) );
+  ASSERT_THAT( paths.find("/dataset1//what"), Eq(H5PathTrie::NO_NODE) );
+  ASSERT_FALSE( h5layout.hasGroup("/dataset1/") );
+  ASSERT_TRUE( h5layout.hasGroup("/dataset1") );
+}
+
+TEST(testH5Layout, layoutSnapshotIsSavedAndLoaded) {
+  const std::string snapshotDir = "./out";
+  const H5Layout fromFile(TEST_ODIM_FILE);
+  H5Layout h5layout;
+  h5layout.setSnapshotCache(snapshotDir, true);
+  h5layout.explore(TEST_ODIM_FILE);
+  h5layout.explore(TEST_ODIM_FILE);
+  std::vector<double> values, snapshotValues;
+  std::string value, snapshotValue;
+
+  ASSERT_TRUE( h5layout.isFromSnapshot() );
+  ASSERT_THAT( h5layout.groups.size(), Eq(fromFile.groups.size()) );
+  ASSERT_THAT( h5layout.datasets.size(), Eq(fromFile.datasets.size()) );
+  ASSERT_THAT( h5layout.attributes.size(), Eq(fromFile.attributes.size()) );
+  for (size_t i=0; i<fromFile.attributes.size(); ++i) {
+    const std::string name = fromFile.attributes[i].name();
+    ASSERT_THAT( h5layout.attributes[i].name(), Eq(name) );
+    ASSERT_THAT( h5layout.attributeInfo(name).typeClass, Eq(fromFile.attributeInfo(name).typeClass) );
+    ASSERT_THAT( h5layout.attributeInfo(name).dims, ContainerEq(fromFile.attributeInfo(name).dims) );
+  }
+  fromFile.getAttributeValue("/dataset1/how/startazA", values);
+  h5layout.getAttributeValue("/dataset1/how/startazA", snapshotValues);
+  ASSERT_THAT( snapshotValues, ContainerEq(values) );
+  fromFile.getAttributeValue("/what/source", value);
+  h5layout.getAttributeValue("/what/source", snapshotValue);
+  ASSERT_THAT( snapshotValue, Eq(value) );
+  ASSERT_TRUE( h5layout.isUcharDataset("/dataset1/data1/data") == fromFile.isUcharDataset("/dataset1/data1/data") );
+
+  h5layout.setSnapshotCache("");
+  h5layout.explore(TEST_ODIM_FILE);
+  ASSERT_FALSE( h5layout.isFromSnapshot() );
+}
+
+class CollectingVisitor : public H5LayoutVisitor {
+  public:
+    std::set<std::string> groups, datasets, attributes;
+    std::string source;
+    std::vector<double> startazA;
+    bool visitGroup(const std::string& path) override {
+      groups.insert(path);
+      return path != "/dataset2";
+    }
+    bool visitDataset(const std::string& path, const bool) override {
+      datasets.insert(path);
+      return true;
+    }
+    void visitAttribute(const std::string& path, const h5AttributeInfo&, const h5AttributeReader& value) override {
+      attributes.insert(path);
+      if ( path == "/what/source" ) value.getValue(source);
+      if ( path == "/dataset1/how/startazA" ) value.getValue(startazA);
+    }
+};
+
+TEST(testH5Layout, visitorGetsObjectsWithoutBuildingLayout) {
+  const H5Layout fromFile(TEST_ODIM_FILE);
+  H5Layout h5layout;
+  CollectingVisitor visitor;
+  h5layout.visit(TEST_ODIM_FILE, visitor);
+  std::string source;
+  std::vector<double> startazA;
+  size_t dataset2Attributes = 0;
+  for (const auto& attr : fromFile.attributes) {
+    if ( attr.name().find("/dataset2/") == 0 && attr.name().find('/', 10) == std::string::npos ) ++dataset2Attributes;
+  }
+
+  ASSERT_THAT( h5layout.attributes, IsEmpty() );
+  ASSERT_THAT( visitor.groups.size(), Eq(fromFile.groups.size()) );
+  ASSERT_THAT( visitor.datasets.size(), Eq(fromFile.datasets.size()) );
+  ASSERT_THAT( visitor.attributes.size(), Eq(fromFile.attributes.size()-dataset2Attributes) );
+  ASSERT_THAT( visitor.attributes.count("/dataset2/what/product"), Eq(1u) );
+  fromFile.getAttributeValue("/what/source", source);
+  fromFile.getAttributeValue("/dataset1/how/startazA", startazA);
+  ASSERT_THAT( visitor.source, Eq(source) );
+  ASSERT_THAT( visitor.startazA, ContainerEq(startazA) );
+  ASSERT_THROW( h5layout.visit(WRONG_ODIM_FILE, visitor), std::runtime_error );
+}
+
+TEST(testH5Layout, batchedReadGivesTheSameValuesAsSingleReads) {
+  const H5Layout single(TEST_ODIM_FILE);
+  H5Layout batched(TEST_ODIM_FILE);
+  const std::vector<std::string> names{"/dataset2/how/startazA", "/what/source", "/dataset1/how/startazA",
+                                       "/dataset1/where/nbins", "/what/nonexisting"};
+  const auto results = batched.readAttributes(names);
+  std::string source;
+  std::vector<double> startazA;
+  std::vector<int64_t> nbins;
+  single.getAttributeValue("/what/source", source);
+  single.getAttributeValue("/dataset1/how/startazA", startazA);
+  single.getAttributeValue("/dataset1/where/nbins", nbins);
+
+  ASSERT_THAT( results.size(), Eq(names.size()) );
+  ASSERT_THAT( results[1].name, Eq("/what/source") );
+  ASSERT_THAT( results[1].typeClass, Eq(H5T_STRING) );
+  ASSERT_THAT( results[1].stringValue, Eq(source) );
+  ASSERT_THAT( results[2].realValues, ContainerEq(startazA) );
+  ASSERT_THAT( results[3].intValues, ContainerEq(nbins) );
+  ASSERT_THAT( results[3].error, IsEmpty() );
+  ASSERT_THAT( results[4].error, HasSubstr("ERROR") );
+  ASSERT_THAT( batched.prefetchedValuesBytes(), Gt(0u) );
+}
+
+TEST(testH5Layout, batchedReadKeepsThePrefetchCap) {
+  H5Layout batched(TEST_ODIM_FILE);
+  H5Layout capped;
+  capped.setValuePrefetch(false, 8);      // /what/source and startazA don`t fit, only nbins
+  capped.explore(TEST_ODIM_FILE);
+  const std::vector<std::string> names{"/what/source", "/dataset1/how/startazA", "/dataset1/where/nbins"};
+  const auto results = batched.readAttributes(names);
+  const auto cappedResults = capped.readAttributes(names);
+
+  ASSERT_THAT( capped.prefetchedValuesBytes(), Lt(batched.prefetchedValuesBytes()) );
+  for (size_t i=0; i<names.size(); ++i) {   // the values not cached are read by the accessors
+    ASSERT_THAT( cappedResults[i].error, IsEmpty() );
+    ASSERT_THAT( cappedResults[i].stringValue, Eq(results[i].stringValue) );
+    ASSERT_THAT( cappedResults[i].realValues, ContainerEq(results[i].realValues) );
+    ASSERT_THAT( cappedResults[i].intValues, ContainerEq(results[i].intValues) );
+  }
+}
+
+TEST(testH5Layout, accessorsLeaveNoOpenHandles) {
+  H5Layout h5layout;
+  h5layout.setHandleCacheSize(0);
+  h5layout.explore(TEST_ODIM_FILE);
+  std::string value;
+  std::vector<double> values;
+  std::string errmsg;
+
+  ASSERT_THAT( h5layout.openObjectCount(), Eq(1u) );   // the file itself
+  for (int i=0; i<3; ++i) {
+    h5layout.getAttributeValue("/what/source", value);
+    h5layout.getAttributeValue("/dataset1/how/startazA", values);
+    h5layout.isFixedLengthStringAttribute("/what/source", errmsg);
+    h5layout.isUcharDataset("/dataset1/data1/data");
+    h5layout.getAttributeNames("/dataset1/what");
+    ASSERT_THROW( h5layout.getAttributeValue("/what/nonexisting", value), std::runtime_error );
+  }
+  ASSERT_THAT( h5layout.openObjectCount(), Eq(1u) );
+
+  h5layout.setHandleCacheSize(2);
+  h5layout.explore(TEST_ODIM_FILE);
+  for (const auto& a : h5layout.attributes) {
+    if ( h5layout.isStringAttribute(a.name()) ) h5layout.getAttributeValue(a.name(), value);
+  }
+  ASSERT_THAT( h5layout.openObjectCount(), Le(3u) );   // the file and the cached parents
+  h5layout.explore(TEST_ODIM_FILE_V24);
+  ASSERT_THAT( h5layout.openObjectCount(), Eq(1u) );
+}
+
+TEST(testH5Layout, tryGetAttributeValueReturnsTypedErrors) {
+  const H5Layout h5layout("./data/test/T_PAJZ41_C_LZIB_20231023000000.hdf");
+  std::string value;
+  double realValue;
+  std::vector<double> values;
+
+  h5Error error = h5layout.tryGetAttributeValue("/how/system", value);
+  ASSERT_TRUE( static_cast<bool>(error) );
+  ASSERT_THAT( error.kind, Eq(h5Error::WrongStrSize) );
+  ASSERT_TRUE( error.isWarning() );
+  ASSERT_THAT( error.message, HasSubstr("STRSIZE") );
+  ASSERT_THAT( value, Eq("SELE735") );
+
+  error = h5layout.tryGetAttributeValue("/what/object", value);
+  ASSERT_FALSE( static_cast<bool>(error) );
+  ASSERT_THAT( error.message, IsEmpty() );
+
+  ASSERT_THAT( h5layout.tryGetAttributeValue("/what/nonexisting", value).kind, Eq(h5Error::AttributeNotOpened) );
+  ASSERT_THAT( h5layout.tryGetAttributeValue("/nonexisting/object", values).kind, Eq(h5Error::NodeNotOpened) );
+  ASSERT_THAT( h5layout.tryGetAttributeValue("/what/date", realValue).kind, Eq(h5Error::NotRead) );
+  error = h5layout.tryGetAttributeValue("/what/version", values);
+  ASSERT_THAT( error.kind, Eq(h5Error::NotRead) );
+  ASSERT_FALSE( error.isWarning() );
+}
+
+static void findHdf5Files(const std::string& dir, std::vector<std::string>& files) {
+  DIR* d = opendir(dir.c_str());
+  if ( !d ) return;
+  while ( const dirent* entry = readdir(d) ) {
+    const std::string name{entry->d_name};
+    if ( name == "." || name == ".." ) continue;
+    const std::string path = dir+"/"+name;
+    if ( std::regex_match(name, std::regex(".*\\.(h5|hdf|hdf5)")) ) files.push_back(path);
+    else findHdf5Files(path, files);
+  }
+  closedir(d);
+}
+
+TEST(testH5Layout, nativeReaderGivesTheSameLayoutAsHdf5Library) {
+  std::vector<std::string> files;
+  findHdf5Files("./data", files);
+  ASSERT_THAT( files, Not(IsEmpty()) );
+  for (const auto& file : files) {
+    SCOPED_TRACE(file);
+    const H5Layout library(file);
+    H5Layout native;
+    native.setNativeReader(true);
+    native.explore(file);
+
+    ASSERT_FALSE( library.isFromNativeReader() );
+    ASSERT_TRUE( native.isFromNativeReader() );
+    ASSERT_THAT( native.groups.size(), Eq(library.groups.size()) );
+    for (size_t i=0; i<library.groups.size(); ++i) {
+      ASSERT_THAT( native.groups[i].name(), Eq(library.groups[i].name()) );
+    }
+    ASSERT_THAT( native.datasets.size(), Eq(library.datasets.size()) );
+    for (size_t i=0; i<library.datasets.size(); ++i) {
+      ASSERT_THAT( native.datasets[i].name(), Eq(library.datasets[i].name()) );
+    }
+    ASSERT_THAT( native.attributes.size(), Eq(library.attributes.size()) );
+    for (size_t i=0; i<library.attributes.size(); ++i) {
+      const std::string attrName = library.attributes[i].name();
+      ASSERT_THAT( native.attributes[i].name(), Eq(attrName) );
+      const h5AttributeInfo& expected = library.attributeInfo(attrName);
+      const h5AttributeInfo& info = native.attributeInfo(attrName);
+      ASSERT_THAT( info.typeClass, Eq(expected.typeClass) ) << attrName;
+      ASSERT_THAT( info.precision, Eq(expected.precision) ) << attrName;
+      ASSERT_THAT( info.sign, Eq(expected.sign) ) << attrName;
+      ASSERT_THAT( info.strpad, Eq(expected.strpad) ) << attrName;
+      ASSERT_THAT( info.isVariableStr, Eq(expected.isVariableStr) ) << attrName;
+      ASSERT_THAT( info.size, Eq(expected.size) ) << attrName;
+      ASSERT_THAT( info.dims, ContainerEq(expected.dims) ) << attrName;
+
+      std::string expectedStr, str;
+      ASSERT_THAT( native.tryGetAttributeValue(attrName, str).kind,
+                   Eq(library.tryGetAttributeValue(attrName, expectedStr).kind) ) << attrName;
+      ASSERT_THAT( str, Eq(expectedStr) ) << attrName;
+      std::vector<double> expectedReals, reals;
+      ASSERT_THAT( native.tryGetAttributeValue(attrName, reals).kind,
+                   Eq(library.tryGetAttributeValue(attrName, expectedReals).kind) ) << attrName;
+      ASSERT_THAT( reals, Pointwise(NanSensitiveDoubleEq(), expectedReals) ) << attrName;
+      std::vector<int64_t> expectedInts, ints;
+      ASSERT_THAT( native.tryGetAttributeValue(attrName, ints).kind,
+                   Eq(library.tryGetAttributeValue(attrName, expectedInts).kind) ) << attrName;
+      ASSERT_THAT( ints, ContainerEq(expectedInts) ) << attrName;
+    }
+  }
+}
+
 TEST(BUGH5Layout, shouldThrowOnWrongSTRSIZEOfHowSystem) {
   const H5Layout h5layout("./data/test/T_PAJZ41_C_LZIB_20231023000000.hdf");
   std::string attrName = "/how/system";
@@ -243,6 +824,11 @@ TEST(BUGH5Layout, shouldThrowOnWrongSTRSIZEOfHowSystem) {
       throw;
     }
   },std::runtime_error);
+
+  H5Layout prefetched;
+  prefetched.setValuePrefetch(true);
+  prefetched.explore("./data/test/T_PAJZ41_C_LZIB_20231023000000.hdf");
+  ASSERT_THROW( prefetched.getAttributeValue(attrName, stringValue), std::runtime_error );
 }
 
 
@@ -4,6 +4,7 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
 #include "class_OdimStandard.hpp"
+#include "class_H5Layout.hpp"
 
 using namespace testing;
 using namespace myodim;
@@ -81,3 +82,115 @@ TEST(testOdimStandard, canParse2DArrayEntries) {
   ASSERT_TRUE( has2D );
 }
 
+TEST(testOdimStandard, rulesAreCompiledOnceAndFollowTheEntries) {
+  OdimStandard oStand(TEST_CSV_FILE);
+
+  const std::vector<OdimRule>& rules = oStand.rules();
+  ASSERT_THAT( rules.size(), Eq(oStand.entries.size()) );
+  const OdimRule* firstRule = &rules.front();
+  ASSERT_THAT( &oStand.rules().front(), Eq(firstRule) );   // not rebuilt when nothing changed
+  for (int i=0, n=rules.size(); i<n; ++i) {
+    ASSERT_TRUE( rules[i].isCompiled );
+    ASSERT_THAT( rules[i].node, Eq(oStand.entries[i].node) );
+  }
+
+  oStand.entries.push_back(OdimEntry("/dataset[1-9][0-9]*/what/source", "Attribute", "String", "TRUE", "NOD:.*", ""));
+  const OdimRule& added = oStand.rules().back();
+  ASSERT_THAT( oStand.rules().size(), Eq(oStand.entries.size()) );
+  ASSERT_TRUE( std::regex_match("/dataset12/what/source", added.nodeRegex) );
+  ASSERT_TRUE( added.hasValueRegex );
+  ASSERT_TRUE( std::regex_match("NOD:skjav", added.valueRegex) );
+  ASSERT_TRUE( added.hasWildcard && added.hasParentRegex && added.hasWildcardRegex );
+  ASSERT_TRUE( std::regex_match("/dataset12/what/date", added.parentRegex) );
+  ASSERT_TRUE( std::regex_match("/dataset12", added.wildcardRegex) );
+  ASSERT_THAT( added.wildcardRest, Eq("/what/source") );
+
+  oStand.entries.back().possibleValues = "WMO:.*";
+  ASSERT_FALSE( std::regex_match("NOD:skjav", oStand.rules().back().valueRegex) );
+}
+
+TEST(testOdimStandard, pathAutomatonMatchesTheSameAsStdRegex) {
+  const std::vector<std::string> csvFiles{TEST_CSV_FILE, TEST_CSV_FILE_V2_4, "./data/ODIM_H5_V2_2_COMP.csv",
+                                          "./data/ODIM_H5_V2_4_IMAGE.csv", "./data/ODIM_H5_V2_4_SCAN.csv"};
+  const std::vector<std::string> h5Files{"./data/example/T_PAGZ41_C_LZIB_20180403000000.hdf",
+                                         "./data/test/T_PAZE50_C_LFPW_20190426132340.h5",
+                                         "./data/example/T_PASH21_C_EUOC_20230616041500.hdf"};
+  std::vector<std::string> paths{"", "/", "/dataset1x", "/dataset01/what", "/what/source/x"};
+  for (const auto& h5File : h5Files) {
+    const H5Layout h5layout(h5File);
+    for (const auto* objects : {&h5layout.groups, &h5layout.datasets, &h5layout.attributes}) {
+      for (const auto& o : *objects) paths.push_back(o.name());
+    }
+  }
+
+  for (const auto& csvFile : csvFiles) {
+    SCOPED_TRACE(csvFile);
+    const OdimStandard oStand(csvFile);
+    const PathAutomaton& automaton = oStand.pathAutomaton();
+    const std::vector<OdimRule>& rules = oStand.rules();
+    ASSERT_THAT( automaton.size(), Eq(2*rules.size()) );
+    std::vector<uint32_t> ids;
+    for (const auto& path : paths) {
+      automaton.match(path, ids);
+      std::vector<uint32_t> expected;
+      for (uint32_t i=0, n=rules.size(); i<n; ++i) {
+        if ( rules[i].isLiteral ) {   // looked up directly, not in the automaton
+          ASSERT_THAT( std::regex_match(path, rules[i].nodeRegex), Eq(path == rules[i].literal) ) << rules[i].node;
+        }
+        else if ( std::regex_match(path, rules[i].nodeRegex) ) {
+          expected.push_back(i);
+        }
+      }
+      for (uint32_t i=0, n=rules.size(); i<n; ++i) {
+        if ( rules[i].hasParentRegex && std::regex_match(path, rules[i].parentRegex) ) expected.push_back(n+i);
+      }
+      ASSERT_THAT( ids, ContainerEq(expected) ) << path;
+    }
+    for (uint32_t i=0, n=rules.size(); i<n; ++i) {
+      ASSERT_FALSE( automaton.isFallback(i) ) << rules[i].node;
+    }
+  }
+}
+
+TEST(testOdimStandard, pathAutomatonFallsBackToStdRegexForOtherSyntax) {
+  const PathAutomaton automaton({"/dataset[1-9][0-9]*(/data[1-9][0-9]*)?/what", "/data\\d+", "/what/(date|time)",
+                                 "/a{2}b", "[^/]*x", "/how/.*"});
+
+  ASSERT_FALSE( automaton.isFallback(0) );
+  ASSERT_TRUE( automaton.isFallback(1) );
+  ASSERT_FALSE( automaton.isFallback(2) );
+  ASSERT_TRUE( automaton.isFallback(3) );
+  ASSERT_FALSE( automaton.isFallback(4) );
+  std::vector<uint32_t> ids;
+  automaton.match("/dataset12/data3/what", ids);
+  ASSERT_THAT( ids, ElementsAre(0u) );
+  automaton.match("/data42", ids);
+  ASSERT_THAT( ids, ElementsAre(1u) );
+  automaton.match("/what/time", ids);
+  ASSERT_THAT( ids, ElementsAre(2u) );
+  automaton.match("/aab", ids);
+  ASSERT_THAT( ids, ElementsAre(3u) );
+  automaton.match("abx", ids);
+  ASSERT_THAT( ids, ElementsAre(4u) );
+  automaton.match("/how/x", ids);
+  ASSERT_THAT( ids, ElementsAre(5u) );
+  automaton.match("/where", ids);
+  ASSERT_THAT( ids, IsEmpty() );
+  ASSERT_THAT( automaton.dfaStateCount(), Gt(1u) );
+}
+
+TEST(testOdimStandard, literalNodesAreRecognized) {
+  OdimStandard oStand;
+  oStand.entries.push_back(OdimEntry("/what/object", "Attribute", "String", "TRUE", "", ""));
+  oStand.entries.push_back(OdimEntry("/how/a\\.b", "Attribute", "String", "TRUE", "", ""));
+  oStand.entries.push_back(OdimEntry("/dataset[1-9][0-9]*/what", "Group", "String", "TRUE", "", ""));
+  oStand.entries.push_back(OdimEntry(".*how/NI", "Attribute", "Real", "FALSE", "", ""));
+
+  const std::vector<OdimRule>& rules = oStand.rules();
+  ASSERT_TRUE( rules[0].isLiteral );
+  ASSERT_THAT( rules[0].literal, Eq("/what/object") );
+  ASSERT_TRUE( rules[1].isLiteral );
+  ASSERT_THAT( rules[1].literal, Eq("/how/a.b") );
+  ASSERT_FALSE( rules[2].isLiteral );
+  ASSERT_FALSE( rules[3].isLiteral );
+}